@@ -32,6 +32,7 @@ public:
     int AsyncWaitTimeout = -1;
     std::function<void(AsyncWaitEvent &event)> AsyncWaitCallback;
     bool AsyncWaitOneShot = false;
+    bool AsyncWaitBatch = false;
 
     int LastError = 0;
     std::string LastErrorMsg;
@@ -110,6 +111,8 @@ int Connection::ConnectionImpl::Connect()
             Req.mutable_asyncwait()->add_name(name);
         if (AsyncWaitTimeout >= 0)
             Req.mutable_asyncwait()->set_timeout_ms(AsyncWaitTimeout * 1000);
+        if (AsyncWaitBatch)
+            Req.mutable_asyncwait()->set_batch(true);
         return Call();
     }
 
@@ -186,6 +189,22 @@ int Connection::ConnectionImpl::Recv(rpc::TContainerResponse &rsp) {
                 };
                 AsyncWaitCallback(event);
 
+                if (AsyncWaitOneShot)
+                    return EError::Success;
+            }
+        } else if (rsp.has_asyncwaitbatch()) {
+            if (AsyncWaitCallback) {
+                for (auto &wait: rsp.asyncwaitbatch().event()) {
+                    AsyncWaitEvent event = {
+                        (time_t)wait.when(),
+                        wait.name(),
+                        wait.state(),
+                        wait.label(),
+                        wait.value(),
+                    };
+                    AsyncWaitCallback(event);
+                }
+
                 if (AsyncWaitOneShot)
                     return EError::Success;
             }
@@ -312,8 +331,10 @@ int Connection::CreateWeakContainer(const std::string &name) {
     return Impl->Call();
 }
 
-int Connection::Destroy(const std::string &name) {
+int Connection::Destroy(const std::string &name, bool async) {
     Impl->Req.mutable_destroy()->set_name(name);
+    if (async)
+        Impl->Req.mutable_destroy()->set_async(true);
 
     return Impl->Call();
 }
@@ -544,10 +565,14 @@ int Connection::AsyncWait(const std::vector<std::string> &containers,
                           const std::vector<std::string> &labels,
                           std::function<void(AsyncWaitEvent &event)> callback,
                           int timeout,
-                          const std::string &targetState) {
+                          const std::string &targetState,
+                          bool batch) {
     Impl->AsyncWaitContainers.clear();
     Impl->AsyncWaitTimeout = timeout;
     Impl->AsyncWaitCallback = callback;
+    Impl->AsyncWaitBatch = batch;
+    if (batch)
+        Impl->Req.mutable_asyncwait()->set_batch(true);
     for (auto &name: containers)
         Impl->Req.mutable_asyncwait()->add_name(name);
     for (auto &label: labels)
@@ -1071,13 +1096,31 @@ int Connection::CreateFromSpec(const rpc::TContainerSpec &container, std::vector
     return Impl->Call();
 }
 
-int Connection::UpdateFromSpec(const rpc::TContainerSpec &container) {
+int Connection::UpdateFromSpec(const rpc::TContainerSpec &container, std::vector<std::string> *changed) {
     auto req = Impl->Req.mutable_updatefromspec();
 
     auto ct = req->mutable_container();
     *ct = container;
 
-    return Impl->Call();
+    int ret = Impl->Call();
+    if (ret || !changed)
+        return ret;
+
+    for (auto &field : Impl->Rsp.updatefromspec().changed())
+        changed->push_back(field);
+
+    return EError::Success;
+}
+
+const rpc::TStartContainersResponse *Connection::StartContainers(const std::vector<std::string> &names) {
+    auto req = Impl->Req.mutable_startcontainers();
+
+    for (auto &name : names)
+        req->add_name(name);
+
+    if (Impl->Call())
+        return nullptr;
+    return &Impl->Rsp.startcontainers();
 }
 
 int Connection::ListVolumesBy(const rpc::TGetVolumeRequest &getVolumeRequest, std::vector<rpc::TVolumeSpec> &volumes) {
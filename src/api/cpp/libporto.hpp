@@ -21,6 +21,7 @@ namespace rpc {
     class TListContainersRequest;
     class TGetVolumeRequest;
     class TDockerImage;
+    class TStartContainersResponse;
 }
 
 namespace Porto {
@@ -142,7 +143,7 @@ public:
 
     int Create(const std::string &name);
     int CreateWeakContainer(const std::string &name);
-    int Destroy(const std::string &name);
+    int Destroy(const std::string &name, bool async = false);
 
     int Start(const std::string &name);
     int Stop(const std::string &name, int timeout = -1);
@@ -159,7 +160,8 @@ public:
                   const std::vector<std::string> &labels,
                   std::function<void(AsyncWaitEvent &event)> callbacks,
                   int timeout = INFINITE_TIMEOUT,
-                  const std::string &targetState = "");
+                  const std::string &targetState = "",
+                  bool batch = false);
 
     int StopAsyncWait(const std::vector<std::string> &containers,
                       const std::vector<std::string> &labels,
@@ -278,7 +280,8 @@ public:
     int GetContainerSpec(const std::string &name, rpc::TContainer &container);
     int ListContainersBy(const rpc::TListContainersRequest &listContainersRequest, std::vector<rpc::TContainer> &containers);
     int CreateFromSpec(const rpc::TContainerSpec &container, std::vector<rpc::TVolumeSpec> volumes, bool start = false);
-    int UpdateFromSpec(const rpc::TContainerSpec &container);
+    int UpdateFromSpec(const rpc::TContainerSpec &container, std::vector<std::string> *changed = nullptr);
+    const rpc::TStartContainersResponse *StartContainers(const std::vector<std::string> &names);
 
     int ListVolumesBy(const rpc::TGetVolumeRequest &getVolumeRequest, std::vector<rpc::TVolumeSpec> &volumes);
 
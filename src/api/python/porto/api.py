@@ -59,6 +59,7 @@ class _RPC(object):
         self.async_wait_names = []
         self.async_wait_callback = None
         self.async_wait_timeout = None
+        self.async_wait_batch = False
 
     def _connect(self):
         if self.connect_time:
@@ -132,14 +133,21 @@ class _RPC(object):
             rsp.ParseFromString(bytes(self._recv_data(length)))
 
             if rsp.HasField('AsyncWait'):
-                if self.async_wait_callback is not None:
-                    if rsp.AsyncWait.HasField("label"):
-                        self.async_wait_callback(name=rsp.AsyncWait.name, state=rsp.AsyncWait.state, when=rsp.AsyncWait.when, label=rsp.AsyncWait.label, value=rsp.AsyncWait.value)
-                    else:
-                        self.async_wait_callback(name=rsp.AsyncWait.name, state=rsp.AsyncWait.state, when=rsp.AsyncWait.when)
+                self._async_wait_report(rsp.AsyncWait)
+            elif rsp.HasField('AsyncWaitBatch'):
+                for event in rsp.AsyncWaitBatch.event:
+                    self._async_wait_report(event)
             else:
                 return rsp
 
+    def _async_wait_report(self, event):
+        if self.async_wait_callback is None:
+            return
+        if event.HasField("label"):
+            self.async_wait_callback(name=event.name, state=event.state, when=event.when, label=event.label, value=event.value)
+        else:
+            self.async_wait_callback(name=event.name, state=event.state, when=event.when)
+
     def encode_request(self, request):
         req = request.SerializeToString()
         length = len(req)
@@ -229,17 +237,20 @@ class _RPC(object):
         request.AsyncWait.name.extend(self.async_wait_names)
         if self.async_wait_timeout is not None:
             request.AsyncWait.timeout_ms = int(self.async_wait_timeout * 1000)
+        if self.async_wait_batch:
+            request.AsyncWait.batch = True
 
         self.sock.sendall(self.encode_request(request))
         response = self._recv_response()
         if response.error != rpc_pb2.Success:
             raise exceptions.PortoException.Create(response.error, response.errorMsg)
 
-    def async_wait(self, names, labels, callback, timeout):
+    def async_wait(self, names, labels, callback, timeout, batch=False):
         with self.lock:
             self.async_wait_names = names
             self.async_wait_callback = callback
             self.async_wait_timeout = timeout
+            self.async_wait_batch = batch
 
         request = rpc_pb2.TContainerRequest()
         request.AsyncWait.name.extend(names)
@@ -247,6 +258,8 @@ class _RPC(object):
             request.AsyncWait.timeout_ms = int(timeout * 1000)
         if labels is not None:
             request.AsyncWait.label.extend(labels)
+        if batch:
+            request.AsyncWait.batch = True
 
         self.call(request)
 
@@ -342,7 +355,7 @@ class Container(object):
         spec = rpc_pb2.TContainerSpec()
         spec.CopyFrom(new_spec)
         spec.name = self.name
-        self.conn.SetSpec(spec)
+        return self.conn.SetSpec(spec)
 
 class Layer(object):
     def __init__(self, conn, name, place=None, pb=None):
@@ -704,6 +717,7 @@ class Connection(object):
         request = rpc_pb2.TContainerRequest()
         request.UpdateFromSpec.container.CopyFrom(spec)
         resp = self.rpc.call(request)
+        return list(resp.UpdateFromSpec.changed)
 
     def CreateSpec(self, container, volume=None, start=False):
         request = rpc_pb2.TContainerRequest()
@@ -742,11 +756,13 @@ class Connection(object):
             raise e
         return ct
 
-    def Destroy(self, container):
+    def Destroy(self, container, asynchronous=False):
         if isinstance(container, Container):
             container = container.name
         request = rpc_pb2.TContainerRequest()
         request.destroy.name = container
+        if asynchronous:
+            setattr(request.destroy, 'async', True)
         self.rpc.call(request)
 
     def Start(self, name, timeout=None):
@@ -754,6 +770,18 @@ class Connection(object):
         request.start.name = name
         self.rpc.call(request, timeout)
 
+    def StartContainers(self, names, timeout=None):
+        request = rpc_pb2.TContainerRequest()
+        request.StartContainers.name.extend(names)
+        resp = self.rpc.call(request, timeout)
+        res = {}
+        for result in resp.StartContainers.result:
+            if result.error:
+                res[result.name] = exceptions.PortoException.Create(result.error, result.errorMsg)
+            else:
+                res[result.name] = None
+        return res
+
     def Stop(self, name, timeout=None):
         request = rpc_pb2.TContainerRequest()
         request.stop.name = name
@@ -907,8 +935,8 @@ class Connection(object):
         except exceptions.WaitContainerTimeout:
             return ""
 
-    def AsyncWait(self, containers, callback, timeout=None, labels=None):
-        self.rpc.async_wait([str(ct) for ct in containers], labels, callback, timeout)
+    def AsyncWait(self, containers, callback, timeout=None, labels=None, batch=False):
+        self.rpc.async_wait([str(ct) for ct in containers], labels, callback, timeout, batch)
 
     def WaitLabels(self, containers, labels, timeout=None):
         request = rpc_pb2.TContainerRequest()
@@ -3,6 +3,8 @@
 #include <csignal>
 #include <unordered_set>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include "cgroup.hpp"
 #include "device.hpp"
@@ -10,6 +12,7 @@
 #include "util/log.hpp"
 #include "util/string.hpp"
 #include "util/unix.hpp"
+#include "util/thread.hpp"
 
 extern "C" {
 #include <fcntl.h>
@@ -37,7 +40,13 @@ const TFlagsNames ControllersName = {
 
 bool TCgroup::IsRestore = false;
 
-static std::map<std::string, std::vector<pid_t>> prevAttachedPidsMap;
+/*
+ * Restore workers attach containers of one level in parallel, parents are
+ * attached at previous level: keep history per source cgroup and compare
+ * with attach from parent of source cgroup.
+ */
+static std::mutex prevAttachedPidsMutex;
+static std::map<std::pair<std::string, std::string>, std::vector<pid_t>> prevAttachedPidsMap;
 
 extern pid_t MasterPid;
 extern pid_t PortodPid;
@@ -280,8 +289,15 @@ TError TCgroup::AttachAll(const TCgroup &cg) const {
 
     L_CG("Attach all processes from {} to {}", cg, *this);
 
-    std::vector<pid_t> pids, prev;
-    std::vector<pid_t>& prevAttachPids = prevAttachedPidsMap[this->Type()];
+    std::vector<pid_t> pids, prev, prevAttachPids;
+    auto prevAttachKey = std::make_pair(this->Type(), cg.Name);
+
+    if (IsRestore) {
+        std::unique_lock<std::mutex> lock(prevAttachedPidsMutex);
+        auto it = prevAttachedPidsMap.find(std::make_pair(this->Type(), TPath(cg.Name).DirName().ToString()));
+        if (it != prevAttachedPidsMap.end())
+            prevAttachPids = it->second;
+    }
 
     bool retry;
     TError error = cg.GetProcesses(pids);
@@ -319,6 +335,8 @@ TError TCgroup::AttachAll(const TCgroup &cg) const {
         error = GetProcesses(prevAttachPids);
         if (error)
             return error;
+        std::unique_lock<std::mutex> lock(prevAttachedPidsMutex);
+        prevAttachedPidsMap[prevAttachKey].swap(prevAttachPids);
     }
 
     return OK;
@@ -419,11 +437,40 @@ void TCgroup::StartRestore() {
 }
 
 void TCgroup::FinishRestore() {
+    std::unique_lock<std::mutex> lock(prevAttachedPidsMutex);
     prevAttachedPidsMap.clear();
     IsRestore = false;
 }
+
+/* cgroup.kill has no filter, portod threads could be attached into subtree */
+bool TCgroup::HasPortoTasks() const {
+    std::vector<TCgroup> cgroups;
+    std::vector<pid_t> tasks, pids;
+
+    if (ChildsAll(cgroups))
+        return true;
+    cgroups.push_back(*this);
+
+    for (auto &cg: cgroups) {
+        if (cg.GetTasks(pids))
+            return true;
+        tasks.insert(tasks.end(), pids.begin(), pids.end());
+    }
+
+    std::lock_guard<std::mutex> lock(TidsMutex);
+    for (auto pid: tasks) {
+        if (PortoTids.count(pid) || pid == MasterPid || pid == PortodPid || pid <= 0) {
+            L_CG("Cannot kill {} by cgroup.kill: portod thread {} inside", *this, pid);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 TError TCgroup::KillAll(int signal) const {
-    std::vector<pid_t> tasks, killed;
+    std::vector<pid_t> tasks;
+    std::unordered_set<pid_t> killed, current;
     TError error, error2;
     bool retry;
     bool frozen = false;
@@ -434,9 +481,19 @@ TError TCgroup::KillAll(int signal) const {
     if (IsRoot())
         return TError(EError::Permission, "Bad idea");
 
+    /* Kernel kills whole subtree and races with forks by itself */
+    if (IsCgroup2() && signal == SIGKILL && Has("cgroup.kill") && !HasPortoTasks()) {
+        error = Set("cgroup.kill", "1");
+        if (!error)
+            return OK;
+        L_WRN("Cannot kill {} by cgroup.kill: {}", *this, error);
+        error = OK;
+    }
+
     do {
-        if (++iteration > 10 && !frozen && FreezerSubsystem.IsBound(*this) &&
-                !FreezerSubsystem.IsFrozen(*this)) {
+        /* Frozen tasks cannot fork, SIGKILL works after thaw */
+        if ((signal == SIGKILL || ++iteration > 10) && !frozen &&
+                FreezerSubsystem.IsBound(*this) && !FreezerSubsystem.IsFrozen(*this)) {
             error = FreezerSubsystem.Freeze(*this, false);
             if (error)
                 L_ERR("Cannot freeze cgroup for killing {} : {}", *this, error);
@@ -447,16 +504,20 @@ TError TCgroup::KillAll(int signal) const {
         if (error)
             break;
         retry = false;
-        for (auto pid: tasks) {
-            std::unique_lock<std::mutex> lock(TidsMutex);
-            bool portoThread = PortoTids.find(pid) != PortoTids.end();
-            lock.unlock();
+        current.clear();
 
-            if (portoThread || pid == MasterPid || pid == PortodPid || pid <= 0) {
+        std::unique_lock<std::mutex> lock(TidsMutex);
+        for (auto pid: tasks) {
+            if (PortoTids.count(pid) || pid == MasterPid || pid == PortodPid || pid <= 0) {
                 L_TAINT(fmt::format("Cannot kill portod thread {}", pid));
                 continue;
             }
-            if (std::find(killed.begin(), killed.end(), pid) == killed.end()) {
+            current.insert(pid);
+        }
+        lock.unlock();
+
+        for (auto pid: current) {
+            if (!killed.count(pid)) {
                 if (kill(pid, signal) && errno != ESRCH && !error) {
                     error = TError::System("kill");
                     L_ERR("Cannot kill process {} : {}", pid, error);
@@ -464,7 +525,7 @@ TError TCgroup::KillAll(int signal) const {
                 retry = true;
             }
         }
-        killed = tasks;
+        killed.swap(current);
     } while (retry);
 
     if (frozen)
@@ -1638,3 +1699,138 @@ TError InitializeDaemonCgroups() {
 
     return OK;
 }
+
+/* Cgroup pool */
+
+static std::mutex PoolMutex;
+static std::condition_variable PoolCv;
+static std::map<const TSubsystem *, std::vector<TCgroup>> PoolCgroups;
+static std::vector<TCgroup> PoolTrash;
+static std::unique_ptr<std::thread> PoolThread;
+static bool PoolStopping = false;
+static uint64_t PoolSeq = 0;
+
+/* Cgroup2 cannot be renamed, cgroup1 - only within parent */
+static bool PoolHierarchy(const TSubsystem *hy) {
+    return !(hy->Controllers & (CGROUP2 | CGROUP_SYSTEMD));
+}
+
+/* Siblings of top-level containers, '%' is not allowed in names */
+static TCgroup PoolCgroup(const TSubsystem *hy, const std::string &kind, uint64_t seq) {
+    std::string name = std::string(PORTO_CGROUP_PREFIX) +
+        (hy->Controllers & CGROUP_FREEZER ? "/" : "%") +
+        fmt::format("%{}%{}-{}", kind, PortodPid, seq);
+    return hy->Cgroup(name);
+}
+
+static void PoolLoop() {
+    auto lock = std::unique_lock<std::mutex>(PoolMutex);
+
+    while (!PoolStopping) {
+        size_t size = config().daemon().cgroup_pool_size();
+
+        while (!PoolTrash.empty() && !PoolStopping) {
+            TCgroup cg = PoolTrash.back();
+            PoolTrash.pop_back();
+            lock.unlock();
+            TError error = cg.Remove();
+            if (error)
+                L_WRN("Cannot remove cgroup {} from pool : {}", cg, error);
+            lock.lock();
+        }
+
+        for (auto hy: Hierarchies) {
+            if (!PoolHierarchy(hy))
+                continue;
+
+            while (PoolCgroups[hy].size() < size && !PoolStopping) {
+                TCgroup cg = PoolCgroup(hy, "pool", ++PoolSeq);
+                lock.unlock();
+                TError error = cg.Create();
+                if (error)
+                    (void)cg.RemoveOne();
+                lock.lock();
+                if (error) {
+                    L_WRN("Cannot refill cgroup pool : {}", error);
+                    break;
+                }
+                PoolCgroups[hy].push_back(cg);
+                Statistics->CgroupPoolCreated++;
+            }
+        }
+
+        PoolCv.wait_for(lock, std::chrono::seconds(1));
+    }
+}
+
+void TCgroupPool::Start() {
+    if (!config().daemon().cgroup_pool_size())
+        return;
+    PoolStopping = false;
+    PoolThread = std::unique_ptr<std::thread>(NewThread(&PoolLoop));
+}
+
+void TCgroupPool::Stop() {
+    if (!PoolThread)
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(PoolMutex);
+    PoolStopping = true;
+    PoolCv.notify_all();
+    lock.unlock();
+
+    PoolThread->join();
+    PoolThread = nullptr;
+}
+
+bool TCgroupPool::Take(const TSubsystem &hierarchy, TCgroup &cg) {
+    auto lock = std::unique_lock<std::mutex>(PoolMutex);
+
+    if (!PoolThread || !PoolHierarchy(&hierarchy))
+        return false;
+
+    auto &pool = PoolCgroups[&hierarchy];
+    while (!pool.empty()) {
+        TCgroup poolCg = pool.back();
+        pool.pop_back();
+        PoolCv.notify_all();
+
+        lock.unlock();
+        TError error = poolCg.Rename(cg);
+        lock.lock();
+
+        if (!error) {
+            Statistics->CgroupPoolTaken++;
+            return true;
+        }
+
+        L_WRN("Cannot take cgroup {} from pool : {}", poolCg, error);
+        PoolTrash.push_back(poolCg);
+    }
+
+    return false;
+}
+
+bool TCgroupPool::Trash(const TCgroup &cg) {
+    auto lock = std::unique_lock<std::mutex>(PoolMutex);
+
+    if (!PoolThread || !PoolHierarchy(cg.Subsystem) || !cg.Exists())
+        return false;
+
+    TCgroup trash = PoolCgroup(cg.Subsystem, "trash", ++PoolSeq);
+    TCgroup moved = cg;
+
+    lock.unlock();
+    TError error = moved.Rename(trash);
+    lock.lock();
+
+    if (error) {
+        L_WRN("Cannot move cgroup {} into pool trash : {}", cg, error);
+        return false;
+    }
+
+    PoolTrash.push_back(moved);
+    PoolCv.notify_all();
+
+    return true;
+}
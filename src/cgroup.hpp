@@ -119,6 +119,7 @@ public:
     TError Remove();
     TError RemoveOne();
 
+    bool HasPortoTasks() const;
     TError KillAll(int signal) const;
 
     TError GetProcesses(std::vector<pid_t> &pids) const {
@@ -458,3 +459,16 @@ extern std::vector<TSubsystem *> Hierarchies;
 
 TError InitializeCgroups();
 TError InitializeDaemonCgroups();
+
+/*
+ * Pre-made empty cgroups for top-level containers, taken by rename.
+ * Cgroups of destroyed containers are renamed away and removed later.
+ */
+class TCgroupPool {
+public:
+    static void Start();
+    static void Stop();
+
+    static bool Take(const TSubsystem &hierarchy, TCgroup &cg);
+    static bool Trash(const TCgroup &cg);
+};
@@ -44,6 +44,20 @@ TClient::TClient(const std::string &special) {
     AccessLevel = EAccessLevel::Internal;
 }
 
+/* Internal client acting on behalf of caller in another thread */
+TClient::TClient(const std::string &special, const TClient &caller) {
+    Id = caller.Id;
+    Cred = caller.Cred;
+    TaskCred = caller.TaskCred;
+    Pid = caller.Pid;
+    StartTime = caller.StartTime;
+    Comm = caller.Comm + special;
+    AccessLevel = caller.AccessLevel;
+    PortoNamespace = caller.PortoNamespace;
+    WriteNamespace = caller.WriteNamespace;
+    ClientContainer = caller.ClientContainer;
+}
+
 TClient::~TClient() {
     CloseConnection();
 }
@@ -251,7 +265,10 @@ TError TClient::ResolveContainer(const std::string &relative_name,
     TError error = ResolveName(relative_name, name);
     if (error)
         return error;
-    return TContainer::Find(name, ct);
+    error = TContainer::Find(name, ct);
+    if (!error && ct->IsDestroyQueued())
+        return TError(EError::ContainerDoesNotExist, "container " + name + " is being destroyed");
+    return error;
 }
 
 TError TClient::ControlVolume(const TPath &path, std::shared_ptr<TVolume> &volume, bool read_only) {
@@ -276,9 +293,14 @@ TError TClient::ReadContainer(const std::string &relative_name,
         return error;
     if (LockedContainer) {
         L_WRN("Stale locked container CT{}:{}", LockedContainer->Id, LockedContainer->Name);
-        ReleaseContainer(true);
+        ReleaseContainer();
     }
-    return OK;
+    if (ct->Lazy) {
+        lock.unlock();
+        error = ct->LoadLazy();
+        lock.lock();
+    }
+    return error;
 }
 
 TError TClient::WriteContainer(const std::string &relative_name,
@@ -294,7 +316,14 @@ TError TClient::WriteContainer(const std::string &relative_name,
         return error;
     if (LockedContainer) {
         L_WRN("Stale locked container CT{}:{}", LockedContainer->Id, LockedContainer->Name);
-        ReleaseContainer(true);
+        ReleaseContainer();
+    }
+    if (ct->Lazy) {
+        lock.unlock();
+        error = ct->LoadLazy();
+        lock.lock();
+        if (error)
+            return error;
     }
     error = ct->LockAction(lock);
     if (error)
@@ -307,7 +336,7 @@ TError TClient::LockContainer(std::shared_ptr<TContainer> &ct) {
     auto lock = LockContainers();
     if (LockedContainer) {
         L_WRN("Stale locked container CT{}:{}", LockedContainer->Id, LockedContainer->Name);
-        ReleaseContainer(true);
+        ReleaseContainer();
     }
     TError error = ct->LockAction(lock);
     if (!error)
@@ -315,9 +344,9 @@ TError TClient::LockContainer(std::shared_ptr<TContainer> &ct) {
     return error;
 }
 
-void TClient::ReleaseContainer(bool containers_locked) {
+void TClient::ReleaseContainer() {
     if (LockedContainer) {
-        LockedContainer->UnlockAction(containers_locked);
+        LockedContainer->UnlockAction();
         LockedContainer = nullptr;
     }
 }
@@ -523,8 +552,12 @@ next:
         Length = Offset = 0;
 
         if (!ReportQueue.empty()) {
-            QueueReport(ReportQueue.front(), true);
-            ReportQueue.pop_front();
+            if (BatchReports) {
+                QueueReportBatch();
+            } else {
+                QueueReport(ReportQueue.front(), true);
+                PopReport();
+            }
             goto next;
         }
 
@@ -571,11 +604,7 @@ TError TClient::QueueResponse(rpc::TContainerResponse &response) {
     return OK;
 }
 
-TError TClient::QueueReport(const TContainerReport &report, bool async) {
-    rpc::TContainerResponse rsp;
-
-    rsp.set_error(EError::Success);
-    auto wait = async ? rsp.mutable_asyncwait() : rsp.mutable_wait();
+static void FillWaitResponse(const TContainerReport &report, rpc::TContainerWaitResponse *wait) {
     wait->set_name(report.Name);
     wait->set_state(report.State);
     wait->set_when(report.When);
@@ -585,6 +614,13 @@ TError TClient::QueueReport(const TContainerReport &report, bool async) {
         if (!report.Value.empty())
             wait->set_value(report.Value);
     }
+}
+
+TError TClient::QueueReport(const TContainerReport &report, bool async) {
+    rpc::TContainerResponse rsp;
+
+    rsp.set_error(EError::Success);
+    FillWaitResponse(report, async ? rsp.mutable_asyncwait() : rsp.mutable_wait());
 
     if (Verbose)
         L_RSP("{}Wait name={} state={} {}={} to {}", async ? "Async" : "", report.Name,
@@ -593,20 +629,73 @@ TError TClient::QueueReport(const TContainerReport &report, bool async) {
     return QueueResponse(rsp);
 }
 
+/* Sends all queued async reports in one message */
+TError TClient::QueueReportBatch() {
+    rpc::TContainerResponse rsp;
+
+    rsp.set_error(EError::Success);
+    auto batch = rsp.mutable_asyncwaitbatch();
+    for (auto &report: ReportQueue)
+        FillWaitResponse(report, batch->add_event());
+    if (DroppedReports)
+        batch->set_dropped(DroppedReports);
+
+    if (Verbose)
+        L_RSP("AsyncWaitBatch events={} dropped={} to {}", ReportQueue.size(), DroppedReports, Id);
+
+    ReportQueue.clear();
+    ReportIndex.clear();
+    DroppedReports = 0;
+
+    return QueueResponse(rsp);
+}
+
+void TClient::PopReport() {
+    auto &report = ReportQueue.front();
+    auto it = ReportIndex.find(std::make_pair(report.Name, report.Label));
+    if (it != ReportIndex.end() && it->second == ReportQueue.begin())
+        ReportIndex.erase(it);
+    ReportQueue.pop_front();
+}
+
 TError TClient::MakeReport(const std::string &name, const std::string &state, bool async,
                            const std::string &label, const std::string &value) {
     auto lock = Lock();
     TError error;
 
-    if (async) {
-        if (Sending || Receiving) {
+    if (async && BatchReports) {
+        /* Newer report for the same container and label replaces queued one */
+        auto key = std::make_pair(name, label);
+        auto it = ReportIndex.find(key);
+        if (it != ReportIndex.end()) {
+            it->second->State = state;
+            it->second->When = time(nullptr);
+            it->second->Value = value;
+        } else {
+            /* Zero limit keeps only the latest report */
+            if (!ReportQueue.empty() &&
+                    ReportQueue.size() >= config().daemon().max_queued_reports()) {
+                PopReport();
+                DroppedReports++;
+            }
             ReportQueue.emplace_back(name, state, time(nullptr), label, value);
-            return OK;
+            ReportIndex[key] = std::prev(ReportQueue.end());
         }
-    } else
-        Processing = false;
+        if (Sending || Receiving)
+            return OK;
+        error = QueueReportBatch();
+    } else {
+        if (async) {
+            if (Sending || Receiving) {
+                ReportQueue.emplace_back(name, state, time(nullptr), label, value);
+                return OK;
+            }
+        } else
+            Processing = false;
+
+        error = QueueReport({name, state, time(nullptr), label, value}, async);
+    }
 
-    error = QueueReport({name, state, time(nullptr), label, value}, async);
     if (error)
         return error;
 
@@ -634,8 +723,12 @@ TError TClient::Event(uint32_t events) {
                 QueueRequest();
 
             if (!error && !ReportQueue.empty()) {
-                QueueReport(ReportQueue.front(), true);
-                ReportQueue.pop_front();
+                if (BatchReports) {
+                    QueueReportBatch();
+                } else {
+                    QueueReport(ReportQueue.front(), true);
+                    PopReport();
+                }
                 error = SendResponse(true);
             }
         }
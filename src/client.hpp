@@ -3,6 +3,7 @@
 #include <string>
 #include <mutex>
 #include <list>
+#include <map>
 
 #include "container.hpp"
 #include "waiter.hpp"
@@ -43,6 +44,7 @@ public:
 
     TClient(int fd);
     TClient(const std::string &special);
+    TClient(const std::string &special, const TClient &caller);
     ~TClient();
 
     std::unique_lock<std::mutex> Lock() {
@@ -102,7 +104,7 @@ public:
                           std::shared_ptr<TContainer> &ct, bool child = false);
 
     TError LockContainer(std::shared_ptr<TContainer> &ct);
-    void ReleaseContainer(bool locked = false);
+    void ReleaseContainer();
 
     TPath ComposePath(const TPath &path);
     TPath ResolvePath(const TPath &path);
@@ -113,6 +115,10 @@ public:
     std::shared_ptr<TContainerWaiter> SyncWaiter;
     std::shared_ptr<TContainerWaiter> AsyncWaiter;
     std::list<TContainerReport> ReportQueue;
+    /* Queued batch reports by container name and label */
+    std::map<std::pair<std::string, std::string>, std::list<TContainerReport>::iterator> ReportIndex;
+    bool BatchReports = false;
+    uint64_t DroppedReports = 0;
 
     TError Event(uint32_t events);
     TError ReadRequest(rpc::TContainerRequest &request);
@@ -120,6 +126,8 @@ public:
     TError SendResponse(bool first);
     TError QueueResponse(rpc::TContainerResponse &response);
     TError QueueReport(const TContainerReport &report, bool async);
+    TError QueueReportBatch();
+    void PopReport();
     TError MakeReport(const std::string &name, const std::string &state, bool async,
                       const std::string &label = "", const std::string &value = "");
 
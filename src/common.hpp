@@ -54,6 +54,7 @@ constexpr int DEFAULT_CONTAINER_ID = 2;
 constexpr int LEGACY_CONTAINER_ID = 3;
 constexpr int CONTAINER_ID_MAX = 4095;
 constexpr int CONTAINER_LEVEL_MAX = 16;
+constexpr int CONTAINER_LOCK_SHARDS = 64;
 
 constexpr const char *ROOT_CONTAINER = "/";
 constexpr const char *ROOT_PORTO_NAMESPACE = "/porto/";
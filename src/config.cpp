@@ -52,11 +52,23 @@ static void DefaultConfig() {
 
     config().set_keyvalue_limit(1 << 20);
     config().set_keyvalue_size(32 << 20);
+    config().set_keyvalue_compact_ratio(4);
+    config().set_keyvalue_write_delay_ms(10);
 
     config().mutable_daemon()->set_rw_threads(20);
     config().mutable_daemon()->set_ro_threads(10);
     config().mutable_daemon()->set_io_threads(5);
     config().mutable_daemon()->set_vl_threads(5);
+    config().mutable_daemon()->set_teardown_threads(8);
+    config().mutable_daemon()->set_restore_threads(16);
+    config().mutable_daemon()->set_lazy_restore(false);
+    config().mutable_daemon()->set_event_worker_threads(4);
+    config().mutable_daemon()->set_max_queued_reports(1000);
+    config().mutable_daemon()->set_helpers_zygote(false);
+    config().mutable_daemon()->set_pidfd_exit(true);
+    config().mutable_daemon()->set_cgroup_pool_size(0);
+    config().mutable_daemon()->set_destroy_threads(2);
+    config().mutable_daemon()->set_start_threads(8);
     config().mutable_daemon()->set_tar_path("tar");
     config().mutable_daemon()->set_request_handling_delay_ms(0);
     config().mutable_daemon()->set_docker_images_support(false);
@@ -86,6 +98,8 @@ static void DefaultConfig() {
     config().mutable_container()->set_stdout_limit(8 << 20); /* 8Mb */
     config().mutable_container()->set_stdout_limit_max(1 << 30); /* 1Gb */
     config().mutable_container()->set_std_stream_read_limit(16 << 20); /* 16Mb */
+    config().mutable_container()->set_std_stream_ring(false);
+    config().mutable_container()->set_clone_into_cgroup(true);
 
     config().mutable_container()->set_kill_timeout_ms(1000);
     config().mutable_container()->set_start_timeout_ms(300 * 1000);
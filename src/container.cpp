@@ -19,6 +19,7 @@
 #include "epoll.hpp"
 #include "kvalue.hpp"
 #include "volume.hpp"
+#include "warmpool.hpp"
 #include "util/log.hpp"
 #include "util/string.hpp"
 #include "util/cred.hpp"
@@ -27,6 +28,11 @@
 #include "client.hpp"
 #include "filesystem.hpp"
 #include "rpc.hpp"
+#include "util/thread.hpp"
+#include "util/hgram.hpp"
+#include "util/worker.hpp"
+
+#include <google/protobuf/util/field_mask_util.h>
 
 extern "C" {
 #include <sys/sysinfo.h>
@@ -43,10 +49,14 @@ extern "C" {
 #include <sched.h>
 }
 
+extern __thread char ReqId[9];
+extern bool SupportCgroupNs;
+
 MeasuredMutex ContainersMutex("containers");
-static std::condition_variable ContainersCV;
 std::shared_ptr<TContainer> RootContainer;
-std::map<std::string, std::shared_ptr<TContainer>> Containers;
+std::unordered_map<std::string, std::shared_ptr<TContainer>> Containers;
+std::vector<std::shared_ptr<TContainer>> ContainersById(CONTAINER_ID_MAX + 1);
+std::unordered_map<pid_t, std::weak_ptr<TContainer>> ContainersByPid;
 TPath ContainersKV;
 TIdMap ContainerIdMap(1, CONTAINER_ID_MAX);
 std::vector<ExtraProperty> ExtraProperties;
@@ -179,6 +189,34 @@ std::shared_ptr<TContainer> TContainer::Find(const std::string &name, bool stric
     return nullptr;
 }
 
+std::shared_ptr<TContainer> TContainer::FindById(int id) {
+    PORTO_LOCKED(ContainersMutex);
+    if (id < 0 || id > CONTAINER_ID_MAX)
+        return nullptr;
+    return ContainersById[id];
+}
+
+/* Finds container by pid of its wait or seize task, drops stale entries */
+std::shared_ptr<TContainer> TContainer::FindByExitPid(pid_t pid) {
+    PORTO_LOCKED(ContainersMutex);
+    auto it = ContainersByPid.find(pid);
+    if (it == ContainersByPid.end())
+        return nullptr;
+    auto ct = it->second.lock();
+    if (ct && (ct->WaitTask.Pid == pid || ct->SeizeTask.Pid == pid))
+        return ct;
+    ContainersByPid.erase(it);
+    return nullptr;
+}
+
+void TContainer::IndexExitPids() {
+    auto lock = LockContainers();
+    if (WaitTask.Pid)
+        ContainersByPid[WaitTask.Pid] = shared_from_this();
+    if (SeizeTask.Pid)
+        ContainersByPid[SeizeTask.Pid] = shared_from_this();
+}
+
 TError TContainer::Find(const std::string &name, std::shared_ptr<TContainer> &ct, bool strict) {
     ct = Find(name, strict);
     if (ct)
@@ -213,10 +251,88 @@ TError TContainer::FindTaskContainer(pid_t pid, std::shared_ptr<TContainer> &ct,
     return TContainer::Find(name.substr(prefix.length()), ct, strict);
 }
 
+/*
+ * Action and state lock bookkeeping is sharded by first level container:
+ * lock transitions in disjoint subtrees wait and wake up independently.
+ * Root container operations take all shards in ascending order and wait
+ * at shard zero, other shards kick it when root waiters are present.
+ */
+struct TLockShard {
+    std::mutex Mutex;
+    std::condition_variable CV;
+};
+
+static TLockShard LockShards[CONTAINER_LOCK_SHARDS];
+static std::atomic<int> RootLockWaiters(0);
+
+class TLockShardGuard : public TNonCopyable {
+    const int Shard;
+    const bool All;
+    bool NotifyRoot = false;
+    std::unique_lock<std::mutex> Lock;
+
+public:
+    TLockShardGuard(const TContainer &ct) :
+        Shard(ct.Shard), All(ct.IsRoot()), Lock(LockShards[All ? 0 : Shard].Mutex)
+    {
+        for (int i = 1; All && i < CONTAINER_LOCK_SHARDS; i++)
+            LockShards[i].Mutex.lock();
+    }
+
+    ~TLockShardGuard() {
+        for (int i = CONTAINER_LOCK_SHARDS - 1; All && i > 0; i--)
+            LockShards[i].Mutex.unlock();
+        Lock.unlock();
+        if (NotifyRoot) {
+            std::unique_lock<std::mutex> root(LockShards[0].Mutex);
+            LockShards[0].CV.notify_all();
+        }
+    }
+
+    void Wait() {
+        if (!All) {
+            LockShards[Shard].CV.wait(Lock);
+            return;
+        }
+        RootLockWaiters++;
+        for (int i = CONTAINER_LOCK_SHARDS - 1; i > 0; i--)
+            LockShards[i].Mutex.unlock();
+        LockShards[0].CV.wait(Lock);
+        for (int i = 1; i < CONTAINER_LOCK_SHARDS; i++)
+            LockShards[i].Mutex.lock();
+        RootLockWaiters--;
+    }
+
+    /* not so effective and fair but simple */
+    void Notify() {
+        if (All) {
+            for (auto &shard: LockShards)
+                shard.CV.notify_all();
+            return;
+        }
+        LockShards[Shard].CV.notify_all();
+        if (Shard && RootLockWaiters)
+            NotifyRoot = true;
+    }
+};
+
 /* lock subtree shared or exclusive */
 TError TContainer::LockAction(std::unique_lock<std::mutex> &containers_lock, bool shared) {
     L_DBG("LockAction{} CT{}:{}", (shared ? "Shared" : ""), Id, Name);
 
+    /* Lock transitions are handled by shard, registry lock is not required */
+    containers_lock.unlock();
+
+    TError error = LockActionShard(shared);
+
+    containers_lock.lock();
+
+    return error;
+}
+
+TError TContainer::LockActionShard(bool shared) {
+    TLockShardGuard guard(*this);
+
     while (1) {
         if (State == EContainerState::Destroyed) {
             L_DBG("Lock failed, CT{}:{} was destroyed", Id, Name);
@@ -233,7 +349,7 @@ TError TContainer::LockAction(std::unique_lock<std::mutex> &containers_lock, boo
             break;
         if (!shared)
             PendingWrite = true;
-        ContainersCV.wait(containers_lock);
+        guard.Wait();
     }
     PendingWrite = false;
     ActionLocked += shared ? 1 : -1;
@@ -247,10 +363,10 @@ TError TContainer::LockAction(std::unique_lock<std::mutex> &containers_lock, boo
     return OK;
 }
 
-void TContainer::UnlockAction(bool containers_locked) {
+/* Caller might hold ContainersMutex, shards are nested into it */
+void TContainer::UnlockAction() {
     L_DBG("UnlockAction{} CT{}:{}", (ActionLocked > 0 ? "Shared" : ""), Id, Name);
-    if (!containers_locked)
-        ContainersMutex.lock();
+    TLockShardGuard guard(*this);
     for (auto ct = Parent.get(); ct; ct = ct->Parent.get()) {
         if (ActionLocked > 0) {
             PORTO_ASSERT(ct->SubtreeRead > 0);
@@ -262,10 +378,7 @@ void TContainer::UnlockAction(bool containers_locked) {
     }
     PORTO_ASSERT(ActionLocked);
     ActionLocked += (ActionLocked > 0) ? -1 : 1;
-    /* not so effective and fair but simple */
-    ContainersCV.notify_all();
-    if (!containers_locked)
-        ContainersMutex.unlock();
+    guard.Notify();
 }
 
 bool TContainer::IsActionLocked(bool shared) {
@@ -276,7 +389,7 @@ bool TContainer::IsActionLocked(bool shared) {
 }
 
 void TContainer::DowngradeActionLock() {
-    auto lock = LockContainers();
+    TLockShardGuard guard(*this);
     PORTO_ASSERT(ActionLocked == -1);
 
     L_DBG("Downgrading exclusive to shared CT{}:{}", Id, Name);
@@ -287,12 +400,12 @@ void TContainer::DowngradeActionLock() {
     }
 
     ActionLocked = 1;
-    ContainersCV.notify_all();
+    guard.Notify();
 }
 
 /* only after downgrade */
 void TContainer::UpgradeActionLock() {
-    auto lock = LockContainers();
+    TLockShardGuard guard(*this);
 
     L_DBG("Upgrading shared back to exclusive CT{}:{}", Id, Name);
 
@@ -304,7 +417,7 @@ void TContainer::UpgradeActionLock() {
     }
 
     while (ActionLocked != 1)
-        ContainersCV.wait(lock);
+        guard.Wait();
 
     ActionLocked = -1;
     LastActionPid = GetTid();
@@ -313,53 +426,52 @@ void TContainer::UpgradeActionLock() {
 }
 
 void TContainer::LockStateRead() {
-    auto lock = LockContainers();
+    TLockShardGuard guard(*this);
     L_DBG("LockStateRead CT{}:{}", Id, Name);
     while (StateLocked < 0)
-        ContainersCV.wait(lock);
+        guard.Wait();
     StateLocked++;
     LastStatePid = GetTid();
 }
 
 void TContainer::LockStateWrite() {
-    auto lock = LockContainers();
+    TLockShardGuard guard(*this);
     L_DBG("LockStateWrite CT{}:{}", Id, Name);
     while (StateLocked < 0)
-        ContainersCV.wait(lock);
+        guard.Wait();
     StateLocked = -1 - StateLocked;
     while (StateLocked != -1)
-        ContainersCV.wait(lock);
+        guard.Wait();
     LastStatePid = GetTid();
 }
 
 void TContainer::DowngradeStateLock() {
-    auto lock = LockContainers();
+    TLockShardGuard guard(*this);
     L_DBG("DowngradeStateLock CT{}:{}", Id, Name);
     PORTO_ASSERT(StateLocked == -1);
     StateLocked = 1;
-    ContainersCV.notify_all();
+    guard.Notify();
 }
 
 void TContainer::UnlockState() {
-    auto lock = LockContainers();
+    TLockShardGuard guard(*this);
     L_DBG("UnlockState CT{}:{}", Id, Name);
     PORTO_ASSERT(StateLocked);
     if (StateLocked > 0)
         --StateLocked;
     else if (++StateLocked >= -1)
-        ContainersCV.notify_all();
+        guard.Notify();
 }
 
 void TContainer::DumpLocks() {
     auto lock = LockContainers();
-    for (auto &it: Containers) {
-        auto &ct = it.second;
-        if (ct->ActionLocked || ct->PendingWrite || ct->StateLocked ||
-                ct->SubtreeRead || ct->SubtreeWrite)
+    for (auto &ct: ContainersById) {
+        if (ct && (ct->ActionLocked || ct->PendingWrite || ct->StateLocked ||
+                ct->SubtreeRead || ct->SubtreeWrite))
             L_SYS("CT{}:{} StateLocked {} by {} ActionLocked {} by {} Read {} Write {}{}",
                   ct->Id, ct->Name, ct->StateLocked, ct->LastStatePid,
                   ct->ActionLocked, ct->LastActionPid,
-                  ct->SubtreeRead, ct->SubtreeWrite,
+                  ct->SubtreeRead.load(), ct->SubtreeWrite.load(),
                   (ct->PendingWrite ? " PendingWrite" : ""));
     }
 }
@@ -367,6 +479,7 @@ void TContainer::DumpLocks() {
 void TContainer::Register() {
     PORTO_LOCKED(ContainersMutex);
     Containers[Name] = shared_from_this();
+    ContainersById[Id] = shared_from_this();
     if (Parent)
         Parent->Children.emplace_back(shared_from_this());
     Statistics->ContainersCreated++;
@@ -375,6 +488,12 @@ void TContainer::Register() {
 void TContainer::Unregister() {
     PORTO_LOCKED(ContainersMutex);
     Containers.erase(Name);
+    ContainersById[Id] = nullptr;
+    for (auto pid: {WaitTask.Pid, SeizeTask.Pid}) {
+        auto it = ContainersByPid.find(pid);
+        if (pid && it != ContainersByPid.end() && it->second.lock().get() == this)
+            ContainersByPid.erase(it);
+    }
     if (Parent)
         Parent->Children.remove(shared_from_this());
 
@@ -382,18 +501,24 @@ void TContainer::Unregister() {
     if (error)
         L_WRN("Cannot put CT{}:{} id: {}", Id, Name, error);
 
+    /* Lock waiters check state under shard lock */
+    TLockShardGuard guard(*this);
     PORTO_ASSERT(State == EContainerState::Stopped);
     State = EContainerState::Destroyed;
+    guard.Notify();
 }
 
 TContainer::TContainer(std::shared_ptr<TContainer> parent, int id, const std::string &name) :
     Parent(parent), Level(parent ? parent->Level + 1 : 0), Id(id), Name(name),
     FirstName(!parent ? "" : parent->IsRoot() ? name : name.substr(parent->Name.length() + 1)),
+    Shard(!parent ? 0 : parent->IsRoot() ? id % CONTAINER_LOCK_SHARDS : parent->Shard),
     Stdin(0), Stdout(1), Stderr(2),
     ClientsCount(0), ContainerRequests(0), OomEvents(0)
 {
     Statistics->ContainersCount++;
 
+    KvStorage = std::make_shared<TKeyValueStorage>(ContainersKV / std::to_string(id));
+
     memset(&TaintFlags, 0, sizeof(TaintFlags));
 
     std::fill(PropSet, PropSet + sizeof(PropSet), false);
@@ -548,6 +673,8 @@ TContainer::~TContainer() {
     PORTO_ASSERT(Net == nullptr);
     PORTO_ASSERT(!NetClass.Registered);
     Statistics->ContainersCount--;
+    if (Lazy)
+        Statistics->ContainersLazy--;
     if (TaintFlags.TaintCounted && Statistics->ContainersTainted)
         Statistics->ContainersTainted--;
 }
@@ -567,6 +694,8 @@ TError TContainer::Create(const std::string &name, std::shared_ptr<TContainer> &
     auto lock = LockContainers();
 
     auto parent = TContainer::Find(TContainer::ParentName(name));
+    if (parent && parent->IsDestroyQueued())
+        return TError(EError::ContainerDoesNotExist, "parent container not found for " + name);
     if (parent) {
         if (parent->Level == CONTAINER_LEVEL_MAX)
             return TError(EError::InvalidValue, "You shall not go deeper! Maximum level is {}", CONTAINER_LEVEL_MAX);
@@ -579,8 +708,11 @@ TError TContainer::Create(const std::string &name, std::shared_ptr<TContainer> &
     } else if (name != ROOT_CONTAINER)
         return TError(EError::ContainerDoesNotExist, "parent container not found for " + name);
 
-    if (Containers.find(name) != Containers.end()) {
-        error = TError(EError::ContainerAlreadyExists, "container " + name + " already exists");
+    if (Containers.count(name)) {
+        if (Containers.at(name)->IsDestroyQueued())
+            error = TError(EError::Busy, "container " + name + " is being destroyed");
+        else
+            error = TError(EError::ContainerAlreadyExists, "container " + name + " already exists");
         goto err;
     }
 
@@ -636,7 +768,7 @@ TError TContainer::Create(const std::string &name, std::shared_ptr<TContainer> &
     ct->Register();
 
     if (parent)
-        parent->UnlockAction(true);
+        parent->UnlockAction();
 
     TContainerWaiter::ReportAll(*ct);
 
@@ -644,14 +776,14 @@ TError TContainer::Create(const std::string &name, std::shared_ptr<TContainer> &
 
 err:
     if (parent)
-        parent->UnlockAction(true);
+        parent->UnlockAction();
     if (id >= 0)
         ContainerIdMap.Put(id);
     ct = nullptr;
     return error;
 }
 
-TError TContainer::Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct) {
+TError TContainer::Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct, bool lazy) {
     TError error;
     int id;
 
@@ -681,10 +813,20 @@ TError TContainer::Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct)
 
     lock.unlock();
 
-    error = SystemClient.LockContainer(ct);
+    error = CL->LockContainer(ct);
     if (error)
         goto err;
 
+    if (lazy) {
+        error = ct->LoadHeader(kv);
+        if (error)
+            goto err;
+        ct->Lazy = true;
+        Statistics->ContainersLazy++;
+        CL->ReleaseContainer();
+        return OK;
+    }
+
     error = ct->Load(kv);
     if (error)
         goto err;
@@ -786,7 +928,7 @@ TError TContainer::Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct)
     if (ct->State == EContainerState::Stopped)
         ct->RemoveWorkDir();
 
-    SystemClient.ReleaseContainer();
+    CL->ReleaseContainer();
 
     return OK;
 
@@ -795,12 +937,82 @@ err:
     ct->SetState(EContainerState::Stopped);
     ct->RemoveWorkDir();
     lock.lock();
-    SystemClient.ReleaseContainer(true);
+    CL->ReleaseContainer();
     ct->Unregister();
     ct = nullptr;
     return error;
 }
 
+TError TContainer::RestoreLazy() {
+    TError error;
+
+    if (!Lazy)
+        return OK;
+
+    L_ACT("Restore lazy CT{}:{}", Id, Name);
+
+    TKeyValue node(ContainersKV / std::to_string(Id));
+    error = node.Load();
+    if (!error)
+        error = Load(node);
+    if (error) {
+        L_ERR("Cannot restore lazy CT{}:{}: {}", Id, Name, error);
+        return error;
+    }
+
+    Lazy = false;
+    Statistics->ContainersLazy--;
+    Statistics->ContainersLazyLoaded++;
+
+    SyncState();
+
+    TNetwork::InitClass(*this);
+
+    /* Do not rewrite resolv.conf at restore */
+    TestClearPropDirty(EProperty::RESOLV_CONF);
+
+    if (State == EContainerState::Dead && AutoRespawn)
+        ScheduleRespawn();
+
+    /* Do not apply dynamic properties to dead container */
+    if (State == EContainerState::Dead)
+        memset(PropDirty, 0, sizeof(PropDirty));
+
+    error = Save(false);
+    if (error)
+        L_WRN("Cannot save CT{}:{}: {}", Id, Name, error);
+
+    if (State == EContainerState::Stopped)
+        RemoveWorkDir();
+
+    return OK;
+}
+
+TError TContainer::LoadLazy() {
+    TError error;
+
+    if (!Lazy)
+        return OK;
+
+    if (Parent && Parent->Lazy) {
+        error = Parent->LoadLazy();
+        if (error)
+            return error;
+    }
+
+    auto lock = LockContainers();
+    error = LockAction(lock);
+    lock.unlock();
+    if (error)
+        return error;
+
+    error = RestoreLazy();
+
+    UnlockAction();
+
+    return error;
+}
+
 std::string TContainer::StateName(EContainerState state) {
     switch (state) {
     case EContainerState::Stopped:
@@ -1084,6 +1296,21 @@ void TContainer::SetState(EContainerState next) {
     if (next == EContainerState::Dead && AutoRespawn)
         ScheduleRespawn();
 
+    if (State == EContainerState::Dead)
+        ScheduleAging();
+
+    if (State == EContainerState::Running)
+        TStdStream::TrackRotate(shared_from_this());
+    else if (prev == EContainerState::Running)
+        TStdStream::UntrackRotate(*this);
+
+    if (State == EContainerState::Running ||
+            State == EContainerState::Meta ||
+            State == EContainerState::Paused)
+        TrackExit();
+    else
+        UntrackExit();
+
     DowngradeStateLock();
 
     if (prev == EContainerState::Running || next == EContainerState::Running) {
@@ -1115,6 +1342,14 @@ TError TContainer::Destroy(std::list<std::shared_ptr<TVolume>> &unlinked) {
 
     L_ACT("Destroy CT{}:{}", Id, Name);
 
+    /* Subtree is locked by us, load lazy containers parents first */
+    if (Statistics->ContainersLazy) {
+        auto subtree = Subtree();
+        subtree.reverse();
+        for (auto &ct: subtree)
+            (void)ct->RestoreLazy();
+    }
+
     if (State != EContainerState::Stopped) {
         error = Stop(0);
         if (error)
@@ -1122,19 +1357,36 @@ TError TContainer::Destroy(std::list<std::shared_ptr<TVolume>> &unlinked) {
     }
 
     if (!Children.empty()) {
-        for (auto &ct: Subtree()) {
-            if (ct.get() != this) {
-                TVolume::UnlinkAllVolumes(ct, unlinked);
-                error = ct->Destroy(unlinked);
-                if (error)
-                    return error;
-            }
-        }
+        uint64_t start = GetCurrentTimeMs();
+        std::mutex unlinkedMutex;
+
+        auto subtree = Subtree();
+        subtree.pop_back(); /* this */
+
+        error = ForEachParallel(subtree, ESubtreeOrder::ChildsFirst,
+                                config().daemon().teardown_threads(),
+                                [&](std::shared_ptr<TContainer> &ct) -> TError {
+            std::list<std::shared_ptr<TVolume>> volumes;
+
+            TVolume::UnlinkAllVolumes(ct, volumes);
+            TError error = ct->Destroy(volumes);
+
+            std::unique_lock<std::mutex> lock(unlinkedMutex);
+            unlinked.splice(unlinked.end(), volumes);
+            return error;
+        });
+
+        L_ACT("Destroy CT{}:{} subtree {} containers {} volumes in {} ms",
+              Id, Name, subtree.size(), unlinked.size(), GetCurrentTimeMs() - start);
+
+        if (error)
+            return error;
     }
 
     TVolume::UnlinkAllVolumes(shared_from_this(), unlinked);
 
     TPath path(ContainersKV / std::to_string(Id));
+    KvStorage->Drop();
     error = path.Unlink();
     if (error)
         L_ERR("Can't remove key-value node {}: {}", path, error);
@@ -1148,6 +1400,133 @@ TError TContainer::Destroy(std::list<std::shared_ptr<TVolume>> &unlinked) {
     return OK;
 }
 
+void TContainer::DestroyQueuedContainer(std::shared_ptr<TContainer> ct) {
+    std::list<std::shared_ptr<TVolume>> unlinked;
+    TClient client("<reaper>");
+    TError error;
+
+    client.ClientContainer = RootContainer;
+    client.StartRequest();
+
+    if (!CL->LockContainer(ct)) {
+        uint64_t start = GetCurrentTimeMs();
+
+        error = ct->Destroy(unlinked);
+        if (error) {
+            auto lock = LockContainers();
+            ct->DestroyQueued = false;
+            lock.unlock();
+            ct->ClearProp(EProperty::DESTROY_QUEUED);
+            (void)ct->Save();
+            Statistics->DestroyAsyncFailed++;
+            L_ERR("Cannot destroy CT{}:{} in background: {}", ct->Id, ct->Name, error);
+        } else {
+            Statistics->DestroyAsyncDone++;
+            L_ACT("Destroyed CT{}:{} in background in {} ms",
+                  ct->Id, ct->Name, GetCurrentTimeMs() - start);
+        }
+        CL->ReleaseContainer();
+
+        TVolume::DestroyUnlinked(unlinked);
+    }
+
+    client.FinishRequest();
+}
+
+/* Destroys queued containers in background with low io priority */
+class TDestroyReaper : public TWorker<std::weak_ptr<TContainer>> {
+public:
+    TDestroyReaper(size_t nr) : TWorker("portod-reaper", nr) {}
+
+    const std::weak_ptr<TContainer> &Top() override {
+        return Queue.front();
+    }
+
+    bool Handle(const std::weak_ptr<TContainer> &weakCt) override {
+        auto ct = weakCt.lock();
+
+        /* Best-effort class, lowest priority */
+        (void)SetIoPrio(0, (2 << 13) | 7);
+
+        if (ct)
+            TContainer::DestroyQueuedContainer(ct);
+
+        Statistics->DestroyQueued--;
+        return true;
+    }
+};
+
+static std::unique_ptr<TDestroyReaper> DestroyReaper;
+
+/* Containers queued before restart are queued again or destroyed right away */
+void TContainer::StartDestroyReaper() {
+    std::list<std::shared_ptr<TContainer>> queued;
+
+    Statistics->DestroyQueued = 0;
+
+    auto lock = LockContainers();
+    for (auto &it: Containers)
+        if (it.second->DestroyQueued && !it.second->Parent->IsDestroyQueued())
+            queued.push_back(it.second);
+    lock.unlock();
+
+    if (config().daemon().destroy_threads()) {
+        DestroyReaper = std::unique_ptr<TDestroyReaper>(
+                new TDestroyReaper(config().daemon().destroy_threads()));
+        DestroyReaper->Start();
+    }
+
+    for (auto &ct: queued) {
+        L_ACT("Requeue destroy CT{}:{}", ct->Id, ct->Name);
+        if (DestroyReaper) {
+            Statistics->DestroyQueued++;
+            DestroyReaper->Push(ct);
+        } else
+            DestroyQueuedContainer(ct);
+    }
+}
+
+void TContainer::StopDestroyReaper() {
+    if (DestroyReaper)
+        DestroyReaper->Stop();
+}
+
+/* Container is locked by caller, client doesn't wait for cleanup */
+TError TContainer::DestroyAsync() {
+    if (!DestroyReaper)
+        return TError(EError::NotSupported, "Destroy reaper is not running");
+
+    auto lock = LockContainers();
+    if (DestroyQueued)
+        return OK;
+
+    L_ACT("Queue destroy CT{}:{}", Id, Name);
+
+    DestroyQueued = true;
+    lock.unlock();
+
+    /* Flag survives restart, container stays hidden until destroyed */
+    SetProp(EProperty::DESTROY_QUEUED);
+    TError error = Save();
+    if (error)
+        L_WRN("Cannot save CT{}:{}: {}", Id, Name, error);
+
+    Statistics->DestroyQueued++;
+    DestroyReaper->Push(shared_from_this());
+
+    return OK;
+}
+
+/* Queued for destroy container and its subtree are hidden from clients */
+bool TContainer::IsDestroyQueued() const {
+    PORTO_LOCKED(ContainersMutex);
+    for (auto ptr = this; ptr; ptr = ptr->Parent.get()) {
+        if (ptr->DestroyQueued)
+            return true;
+    }
+    return false;
+}
+
 bool TContainer::IsChildOf(const TContainer &ct) const {
     for (auto ptr = Parent.get(); ptr; ptr = ptr->Parent.get()) {
         if (ptr == &ct)
@@ -1174,6 +1553,110 @@ std::list<std::shared_ptr<TContainer>> TContainer::Childs() {
     return childs;
 }
 
+/* Set in pool workers, nested pools run in their thread */
+static __thread bool ParallelWorker = false;
+
+/*
+ * Apply action to containers using up to "threads" threads including current.
+ * Containers are ordered only with their nearest ancestor from the same list.
+ * After first error no new actions are started, first error is returned.
+ * Extra threads act via own clients with credentials of current client.
+ */
+TError TContainer::ForEachParallel(const std::list<std::shared_ptr<TContainer>> &cts,
+                                   ESubtreeOrder order, unsigned threads,
+                                   const std::function<TError(std::shared_ptr<TContainer> &)> &action) {
+    std::vector<std::shared_ptr<TContainer>> items(cts.begin(), cts.end());
+    std::vector<std::vector<size_t>> dependents(items.size());
+    std::vector<int> pending(items.size(), 0);
+    std::unordered_map<TContainer *, size_t> index;
+    std::list<size_t> ready;
+    std::condition_variable cv;
+    std::mutex mutex;
+    unsigned running = 0;
+    TError result;
+
+    for (size_t i = 0; i < items.size(); i++)
+        index[items[i].get()] = i;
+
+    for (size_t i = 0; i < items.size(); i++) {
+        auto it = index.end();
+        if (order != ESubtreeOrder::Any) {
+            for (auto p = items[i]->Parent.get(); p && it == index.end(); p = p->Parent.get())
+                it = index.find(p);
+        }
+        if (it == index.end())
+            continue;
+        if (order == ESubtreeOrder::ChildsFirst) {
+            dependents[i].push_back(it->second);
+            pending[it->second]++;
+        } else {
+            dependents[it->second].push_back(i);
+            pending[i]++;
+        }
+    }
+
+    for (size_t i = 0; i < items.size(); i++)
+        if (!pending[i])
+            ready.push_back(i);
+
+    auto caller = CL;
+    std::string reqId(ReqId);
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (1) {
+            while (ready.empty() && running && !result)
+                cv.wait(lock);
+            if (ready.empty() || result)
+                break;
+
+            size_t i = ready.front();
+            ready.pop_front();
+            running++;
+            lock.unlock();
+
+            TError error = action(items[i]);
+
+            lock.lock();
+            running--;
+            if (error && !result)
+                result = error;
+            for (auto d: dependents[i])
+                if (!--pending[d])
+                    ready.push_back(d);
+            cv.notify_all();
+        }
+        cv.notify_all();
+    };
+
+    if (ParallelWorker)
+        threads = 1;
+
+    std::vector<std::unique_ptr<std::thread>> workers;
+    for (unsigned i = 1; i < std::min<size_t>(threads, items.size()); i++) {
+        workers.emplace_back(NewThread([&]() {
+            TClient client("<parallel>", caller ? *caller : SystemClient);
+
+            snprintf(ReqId, sizeof(ReqId), "%s", reqId.c_str());
+            ParallelWorker = true;
+
+            client.StartRequest();
+            worker();
+            client.FinishRequest();
+        }));
+    }
+
+    bool nested = ParallelWorker;
+    ParallelWorker = true;
+    worker();
+    ParallelWorker = nested;
+
+    for (auto &thread: workers)
+        thread->join();
+
+    return result;
+}
+
 std::shared_ptr<TContainer> TContainer::GetParent() const {
     return Parent;
 }
@@ -1330,7 +1813,7 @@ void TContainer::CollectOomKills(bool event) {
         lock.unlock();
 
         for (auto p = ct; p ; p = p->Parent)
-            p->Save();
+            p->Save(false);
     }
 }
 
@@ -2619,6 +3102,50 @@ void TContainer::ShutdownOom() {
     OomEvent.Close();
 }
 
+void TContainer::TrackExit() {
+    int fd;
+
+    if (ExitSource || !WaitTask.Pid || !config().daemon().pidfd_exit())
+        return;
+
+    /* Without pidfd exit is reported only by master */
+    TError error = WaitTask.OpenPidfd(fd);
+    if (error) {
+        L_VERBOSE("Cannot track exit of CT{}:{}: {}", Id, Name, error);
+        return;
+    }
+    WaitPidfd.SetFd = fd;
+
+    ExitSource = std::make_shared<TEpollSource>(WaitPidfd.Fd, EPOLL_EVENT_EXIT, shared_from_this());
+    error = EpollLoop->AddSource(ExitSource);
+    if (error) {
+        L_WRN("Cannot track exit of CT{}:{}: {}", Id, Name, error);
+        UntrackExit();
+    }
+}
+
+void TContainer::UntrackExit() {
+    if (ExitSource)
+        EpollLoop->RemoveSource(ExitSource->Fd);
+    ExitSource = nullptr;
+    WaitPidfd.Close();
+}
+
+bool TContainer::RecvExitStatus(pid_t pid, int &status) {
+    if (!WaitPidfd || WaitTask.Pid != pid)
+        return false;
+
+    TError error = WaitTask.GetExitStatus(WaitPidfd.Fd, status);
+    if (error) {
+        L_WRN("Cannot get exit status of CT{}:{} via pidfd: {}", Id, Name, error);
+        /* Wait for report from master */
+        UntrackExit();
+        return false;
+    }
+
+    return true;
+}
+
 TError TContainer::PrepareOomMonitor() {
 
     if (IsRoot() || !(Controllers & CGROUP_MEMORY))
@@ -2768,6 +3295,9 @@ TError TContainer::PrepareCgroups() {
         if (cg.Exists())
             continue;
 
+        if (Level == 1 && TCgroupPool::Take(*hy, cg))
+            continue;
+
         error = cg.Create();
         if (error)
             return error;
@@ -2958,6 +3488,27 @@ TError TContainer::PrepareTask(TTaskEnv &TaskEnv) {
 
     TaskEnv.QuadroFork = !JobMode && !OsMode && !IsMeta();
 
+    /*
+     * Clone task right into own cgroup2. Kernel checks permissions in
+     * current cgroup namespace and new cgroup namespace would be rooted
+     * at intermediate task cgroup, thus only from host cgroup namespace.
+     */
+    TaskEnv.Cgroup2Fd = -1;
+    if (config().container().clone_into_cgroup() &&
+            (Controllers & CGROUP2) && !TaskEnv.TripleFork &&
+            CompareVersions(config().linux_version(), "5.7") >= 0 &&
+            !(SupportCgroupNs && CgroupFs != ECgroupFs::None) &&
+            (TaskEnv.CgFd.GetFd() < 0 ||
+             TaskEnv.CgFd.Inode() == TNamespaceFd::PidInode(getpid(), "ns/cgroup"))) {
+        if (!Cgroup2Dir) {
+            error = Cgroup2Dir.OpenDir(GetCgroup(Cgroup2Subsystem).Path());
+            if (error)
+                L_WRN("Cannot open cgroup2 for clone3: {}", error);
+        }
+        if (Cgroup2Dir)
+            TaskEnv.Cgroup2Fd = Cgroup2Dir.Fd;
+    }
+
     TaskEnv.Mnt.BindMounts = BindMounts;
     TaskEnv.Mnt.Symlink = Symlink;
 
@@ -3145,12 +3696,15 @@ TUlimit TContainer::GetUlimit() const {
 
 TError TContainer::StartTask() {
     TTaskEnv TaskEnv;
+    uint64_t mark = GetCurrentTimeUs();
     TError error;
 
     if (!UserNs) {
         error = TNetwork::StartNetwork(*this, TaskEnv);
         if (error)
             return error;
+        AddStartTiming("task_network", GetCurrentTimeUs() - mark);
+        mark = GetCurrentTimeUs();
     }
 
     if (IsRoot())
@@ -3174,6 +3728,8 @@ TError TContainer::StartTask() {
     if (error)
         return error;
 
+    AddStartTiming("task_prepare", GetCurrentTimeUs() - mark);
+
     /* Meta container without namespaces don't need task */
     if (IsMeta() && !Isolate && NetInherit && !TaskEnv.NewMountNs)
         return OK;
@@ -3237,6 +3793,90 @@ TError TContainer::StartParents() {
     return CL->LockContainer(current);
 }
 
+/* Claimed volume is runtime root, user root property stays unchanged */
+void TContainer::SetWarmRoot(const TPath &path) {
+    WarmRoot = path;
+
+    if (WarmRoot) {
+        Root = Parent->RootPath.InnerPath(WarmRoot).ToString();
+        SetProp(EProperty::WARM_ROOT);
+    } else {
+        Root = "/";
+        ClearProp(EProperty::WARM_ROOT);
+    }
+
+    auto subtree = Subtree();
+    subtree.reverse();
+    for (auto &ct: subtree)
+        ct->RootPath = ct->Parent->RootPath / TPath(ct->Root).NormalPath();
+}
+
+/* Might unlock container, caller must recheck state */
+TError TContainer::PrepareWarmRoot() {
+    std::shared_ptr<TVolume> vol;
+    std::string name = WarmTemplate;
+    TError error;
+
+    if (!Parent || name.empty() || HasProp(EProperty::ROOT) || WarmRoot)
+        return OK;
+
+    if (!TWarmPool::HasTemplate(name))
+        return TError(EError::InvalidValue, "Unknown warm template {}", name);
+
+    if (!TWarmPool::Claim(shared_from_this(), vol)) {
+        rpc::TVolumeSpec spec;
+
+        error = TWarmPool::BuildSpec(name, spec);
+        if (error)
+            return error;
+
+        spec.add_links()->set_container(ROOT_PORTO_NAMESPACE + Name);
+
+        auto current = CL->LockedContainer;
+        CL->ReleaseContainer();
+
+        error = TVolume::Create(spec, vol);
+
+        TError error2 = CL->LockContainer(current);
+        if (error) {
+            L_ERR("Cannot create warm root volume: {}", error);
+            return error;
+        }
+        if (error2)
+            return error2;
+
+        /* Container might be started or changed while unlocked */
+        if (State != EContainerState::Stopped || WarmTemplate != name ||
+                HasProp(EProperty::ROOT) || WarmRoot) {
+            std::list<std::shared_ptr<TVolume>> unlinked;
+
+            (void)vol->UnlinkVolume(shared_from_this(), "", unlinked);
+            TVolume::DestroyUnlinked(unlinked);
+
+            if (State != EContainerState::Stopped)
+                return OK;
+            return TError(EError::InvalidState, "Container {} changed while preparing warm root", Name);
+        }
+    }
+
+    if (!Parent->RootPath.InnerPath(vol->Path)) {
+        std::list<std::shared_ptr<TVolume>> unlinked;
+
+        (void)vol->UnlinkVolume(shared_from_this(), "", unlinked);
+        TVolume::DestroyUnlinked(unlinked);
+        WarmNetns.Close();
+
+        return TError(EError::InvalidValue, "Warm volume {} is outside of parent root", vol->Path);
+    }
+
+    L("Use warm volume {} as root for CT{}:{}", vol->Path, Id, Name);
+    LockStateWrite();
+    SetWarmRoot(vol->Path);
+    UnlockState();
+
+    return OK;
+}
+
 TError TContainer::PrepareStart() {
     TError error;
 
@@ -3408,7 +4048,60 @@ TError TContainer::PrepareStart() {
     return OK;
 }
 
+static const std::vector<unsigned> StartTimingBuckets = {
+    0, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000,
+    100000, 200000, 500000, 1000000, 2000000, 5000000, 10000000
+};
+
+static std::mutex StartTimingsMutex;
+static std::vector<std::pair<std::string, std::shared_ptr<THistogram>>> StartTimingHgram;
+
+void TContainer::AddStartTiming(const std::string &phase, uint64_t timeUs) {
+    std::lock_guard<std::mutex> guard(StartTimingsMutex);
+
+    StartTimings.emplace_back(phase, timeUs);
+
+    auto it = std::find_if(StartTimingHgram.begin(), StartTimingHgram.end(),
+            [&](const std::pair<std::string, std::shared_ptr<THistogram>> &h) { return h.first == phase; });
+    if (it == StartTimingHgram.end())
+        it = StartTimingHgram.emplace(StartTimingHgram.end(), phase,
+                                      std::make_shared<THistogram>(StartTimingBuckets));
+    it->second->Add(std::min(timeUs, (uint64_t)UINT_MAX));
+}
+
+std::vector<std::pair<std::string, uint64_t>> TContainer::GetStartTimings() const {
+    std::lock_guard<std::mutex> guard(StartTimingsMutex);
+    return StartTimings;
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<THistogram>>> TContainer::StartTimingHgrams() {
+    std::lock_guard<std::mutex> guard(StartTimingsMutex);
+    return StartTimingHgram;
+}
+
+/* Records time since previous phase */
+class TStartTimer {
+    TContainer &CT;
+    uint64_t Begin, Mark;
+
+public:
+    TStartTimer(TContainer &ct) : CT(ct) {
+        Begin = Mark = GetCurrentTimeUs();
+    }
+
+    void Phase(const std::string &name) {
+        uint64_t now = GetCurrentTimeUs();
+        CT.AddStartTiming(name, now - Mark);
+        Mark = now;
+    }
+
+    void Total() {
+        CT.AddStartTiming("total", GetCurrentTimeUs() - Begin);
+    }
+};
+
 TError TContainer::Start() {
+    TStartTimer timer(*this);
     TError error;
 
     if (DockerMode) {
@@ -3425,10 +4118,21 @@ TError TContainer::Start() {
     if (State != EContainerState::Stopped)
         return TError(EError::InvalidState, "Cannot start container {} in state {}", Name, StateName(State));
 
+    {
+        std::lock_guard<std::mutex> guard(StartTimingsMutex);
+        StartTimings.clear();
+    }
+
     error = StartParents();
     if (error)
         return error;
 
+    timer.Phase("start_parents");
+
+    error = PrepareWarmRoot();
+    if (error)
+        return error;
+
     /*
      * Container can already be started (and even dead) due to non-atomical lock
      * transfers between parents and children in StartParents() above
@@ -3449,6 +4153,8 @@ TError TContainer::Start() {
         goto err_prepare;
     }
 
+    timer.Phase("prepare_start");
+
     L_ACT("Start CT{}:{}", Id, Name);
 
     SetState(EContainerState::Starting);
@@ -3461,10 +4167,14 @@ TError TContainer::Start() {
     if (error)
         goto err_prepare;
 
+    timer.Phase("prepare_resources");
+
     error = PrepareRuntimeResources();
     if (error)
         goto err;
 
+    timer.Phase("prepare_runtime_resources");
+
     /* Complain about insecure misconfiguration */
     for (auto &taint: Taint()) {
         L_TAINT(taint);
@@ -3480,6 +4190,10 @@ TError TContainer::Start() {
 
     UpgradeActionLock();
 
+    WarmNetns.Close();
+
+    timer.Phase("start_task");
+
     if (error) {
         SetState(EContainerState::Stopping);
         (void)Terminate(0);
@@ -3500,6 +4214,9 @@ TError TContainer::Start() {
         goto err;
     }
 
+    timer.Phase("save");
+    timer.Total();
+
     Statistics->ContainersStarted++;
 
     return OK;
@@ -3509,6 +4226,8 @@ err:
     FreeRuntimeResources();
     (void)FreeResources();
 err_prepare:
+    WarmNetns.Close();
+    TWarmPool::Release(shared_from_this());
     StartError = error;
     SetState(EContainerState::Stopped);
     Statistics->ContainersFailedStart++;
@@ -3578,7 +4297,7 @@ TError TContainer::PrepareRuntimeResources() {
     return OK;
 }
 
-void TContainer::FreeRuntimeResources() {
+void TContainer::FreeRuntimeResources(bool parents) {
     TError error;
 
     CollectOomKills();
@@ -3588,6 +4307,14 @@ void TContainer::FreeRuntimeResources() {
     if (error)
         L_ERR("Cannot update memory soft limit: {}", error);
 
+    if (parents)
+        FreeParentResources();
+}
+
+/* Returns cpus and guarantees to parents, touches state of whole chain */
+void TContainer::FreeParentResources() {
+    TError error;
+
     if (Parent && CpuReserve.Weight()) {
         L_ACT("Release CPUs reserved for CT{}:{}", Id, Name);
         error = Parent->DistributeCpus();
@@ -3621,6 +4348,8 @@ TError TContainer::FreeResources(bool ignore) {
     OomKillsRaw = 0;
     ClearProp(EProperty::OOM_KILLS);
 
+    Cgroup2Dir.Close();
+
     /* Dispose freezer at last because of recovery */
 
     for (auto hy: Hierarchies) {
@@ -3644,6 +4373,8 @@ TError TContainer::FreeResources(bool ignore) {
     Stdout.Remove(*this);
     Stderr.Remove(*this);
 
+    TWarmPool::Release(shared_from_this());
+
     return OK;
 }
 
@@ -3712,6 +4443,13 @@ TError TContainer::Terminate(uint64_t deadline) {
     if (cg.IsEmpty())
         return OK;
 
+    /* Single write into cgroup.kill, leftovers are collected via freezer */
+    if (Controllers & CGROUP2) {
+        error = GetCgroup(Cgroup2Subsystem).KillAll(SIGKILL);
+        if (error)
+            L_WRN("Cannot kill cgroup2 of CT{}:{}: {}", Id, Name, error);
+    }
+
     error = cg.KillAll(SIGKILL);
     if (error)
         return error;
@@ -3720,6 +4458,7 @@ TError TContainer::Terminate(uint64_t deadline) {
 }
 
 void TContainer::ForgetPid() {
+    UntrackExit();
     Task.Pid = 0;
     TaskVPid = 0;
     WaitTask.Pid = 0;
@@ -3731,6 +4470,8 @@ void TContainer::ForgetPid() {
 TError TContainer::Stop(uint64_t timeout) {
     uint64_t deadline = timeout ? GetCurrentTimeMs() + timeout : 0;
     auto freezer = GetCgroup(FreezerSubsystem);
+    unsigned threads = config().daemon().teardown_threads();
+    uint64_t start = GetCurrentTimeMs(), terminated;
     TError error;
 
     if (State == EContainerState::Stopped)
@@ -3755,15 +4496,18 @@ TError TContainer::Stop(uint64_t timeout) {
                 (void)(*it)->WaitTask.Kill(SIGKILL);
     }
 
-    for (auto &ct : subtree) {
+    /* Containers are terminated independently, each might wait for deadline */
+    (void)ForEachParallel(subtree, ESubtreeOrder::Any, threads,
+                          [&](std::shared_ptr<TContainer> &ct) -> TError {
         auto cg = ct->GetCgroup(FreezerSubsystem);
+        TError error;
 
         if (ct->IsRoot() || ct->State == EContainerState::Stopped)
-            continue;
+            return OK;
 
         if (JobMode && (ct->State == EContainerState::Dead)) {
             ct->SetState(EContainerState::Stopping);
-            continue;
+            return OK;
         }
 
         ct->SetState(EContainerState::Stopping);
@@ -3777,19 +4521,35 @@ TError TContainer::Stop(uint64_t timeout) {
             if (error)
                 L_ERR("Cannot thaw CT{}:{}: {}", ct->Id, ct->Name, error);
         }
-    }
+
+        return OK;
+    });
 
     if (timeout)
         CL->LockedContainer->UpgradeActionLock();
 
-    for (auto &ct: subtree) {
+    terminated = GetCurrentTimeMs();
+
+    /* Siblings share parents, cpu distribution is changed one by one */
+    std::mutex parentsMutex;
+
+    /* Cgroups are nested, free childs before parents */
+    error = ForEachParallel(subtree, ESubtreeOrder::ChildsFirst, threads,
+                            [&](std::shared_ptr<TContainer> &ct) -> TError {
+        TError error;
+
         if (ct->State == EContainerState::Stopped)
-            continue;
+            return OK;
 
-        L_ACT("Stop CT{}:{}", Id, Name);
+        L_ACT("Stop CT{}:{}", ct->Id, ct->Name);
 
         TNetwork::StopNetwork(*ct);
-        ct->FreeRuntimeResources();
+        ct->FreeRuntimeResources(false);
+
+        std::unique_lock<std::mutex> parentsLock(parentsMutex);
+        ct->FreeParentResources();
+        parentsLock.unlock();
+
         error = ct->FreeResources(false);
 
         ct->LockStateWrite();
@@ -3829,12 +4589,13 @@ TError TContainer::Stop(uint64_t timeout) {
 
         ct->SetState(EContainerState::Stopped);
 
-        error = ct->Save();
-        if (error)
-            return error;
-    }
+        return ct->Save();
+    });
 
-    return OK;
+    L_ACT("Stop CT{}:{} subtree {} containers terminate {} ms free {} ms",
+          Id, Name, subtree.size(), terminated - start, GetCurrentTimeMs() - terminated);
+
+    return error;
 }
 
 void TContainer::Reap(bool oomKilled) {
@@ -3983,6 +4744,19 @@ TError TContainer::MayRespawn() {
     return OK;
 }
 
+/* Event is ignored if container is restarted or aging time is changed */
+void TContainer::ScheduleAging() {
+    uint64_t due = DeathTime + AgingTime;
+    uint64_t now = GetCurrentTimeMs();
+
+    /* Practically infinite aging time */
+    if (due < DeathTime || due > UINT64_MAX / 2)
+        return;
+
+    TEvent ev(EEventType::DestroyAgedContainer, shared_from_this());
+    EventQueue->Add(due > now ? due - now : 0, ev);
+}
+
 TError TContainer::ScheduleRespawn() {
     TError error = MayRespawn();
     if (!error) {
@@ -4108,39 +4882,81 @@ void TContainer::SyncPropertiesAll() {
     RootContainer->CollectOomKills();
 }
 
-TError TContainer::HasProperty(const std::string &property) const {
-    std::string name = property, index;
-    TError error;
+void TContainer::ResolveProperty(const std::string &name, TResolvedProperty &property) {
+    property.Name = name;
+    property.Property = name;
+    property.Indexed = ParsePropertyName(property.Property, property.Index);
 
-    if (!ParsePropertyName(name, index)) {
+    if (!property.Indexed) {
         auto dot = name.find('.');
         if (dot != std::string::npos) {
-            std::string type = property.substr(0, dot);
-
-            if (type.find_first_not_of(PORTO_LABEL_PREFIX_CHARS) == std::string::npos) {
-                auto lock = LockContainers();
-                return GetLabel(property, type);
+            property.Controller = name.substr(0, dot);
+            if (property.Controller.find_first_not_of(PORTO_LABEL_PREFIX_CHARS) == std::string::npos) {
+                property.Label = true;
+                return;
             }
-
-            if (State == EContainerState::Stopped)
-                return TError(EError::InvalidState, "Not available in stopped state");
-
             for (auto subsys: Subsystems) {
-                if (subsys->Type != type)
-                    continue;
-                if (subsys->Kind & Controllers)
-                    return OK;
-                return TError(EError::NoValue, "Controllers is disabled");
+                if (subsys->Type == property.Controller) {
+                    property.Subsystem = subsys;
+                    break;
+                }
             }
-            return TError(EError::InvalidProperty, "Unknown controller");
+            return;
         }
     }
 
-    auto it = ContainerProperties.find(name);
-    if (it == ContainerProperties.end())
-        return TError(EError::InvalidProperty, "Unknown property");
+    auto it = ContainerProperties.find(property.Property);
+    if (it != ContainerProperties.end())
+        property.Prop = it->second;
+}
 
-    auto prop = it->second;
+void TContainer::ResolveDumpProperties(const std::vector<std::string> &names,
+                                       const std::unordered_map<std::string, std::string> &indexes,
+                                       std::vector<TResolvedProperty> &properties) {
+    properties.resize(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        auto &property = properties[i];
+        property.Name = names[i];
+        property.Property = names[i];
+        auto it = ContainerProperties.find(names[i]);
+        if (it != ContainerProperties.end())
+            property.Prop = it->second;
+        auto index = indexes.find(names[i]);
+        if (index != indexes.end()) {
+            property.Indexed = true;
+            property.Index = index->second;
+        }
+    }
+}
+
+TError TContainer::HasProperty(const std::string &property) const {
+    TResolvedProperty resolved;
+    ResolveProperty(property, resolved);
+    return HasProperty(resolved);
+}
+
+TError TContainer::HasProperty(const TResolvedProperty &property) const {
+    TError error;
+
+    if (property.Label) {
+        std::string value;
+        auto lock = LockContainers();
+        return GetLabel(property.Name, value);
+    }
+
+    if (!property.Controller.empty()) {
+        if (State == EContainerState::Stopped)
+            return TError(EError::InvalidState, "Not available in stopped state");
+        if (!property.Subsystem)
+            return TError(EError::InvalidProperty, "Unknown controller");
+        if (property.Subsystem->Kind & Controllers)
+            return OK;
+        return TError(EError::NoValue, "Controllers is disabled");
+    }
+
+    auto prop = property.Prop;
+    if (!prop)
+        return TError(EError::InvalidProperty, "Unknown property");
 
     if (!prop->IsSupported)
         return TError(EError::NotSupported, "Not supported");
@@ -4162,51 +4978,46 @@ TError TContainer::HasProperty(const std::string &property) const {
     return error;
 }
 
-TError TContainer::GetProperty(const std::string &origProperty, std::string &value) const {
-    TError error;
-    std::string property = origProperty;
-    std::string idx;
-
-    if (!ParsePropertyName(property, idx)) {
-        auto dot = property.find('.');
+TError TContainer::GetProperty(const std::string &property, std::string &value) const {
+    TResolvedProperty resolved;
+    ResolveProperty(property, resolved);
+    return GetProperty(resolved, value);
+}
 
-        if (dot != std::string::npos) {
-            std::string type = property.substr(0, dot);
+TError TContainer::GetProperty(const TResolvedProperty &property, std::string &value) const {
+    TError error;
 
-            if (type.find_first_not_of(PORTO_LABEL_PREFIX_CHARS) == std::string::npos) {
-                auto lock = LockContainers();
-                return GetLabel(property, value);
-            }
+    if (property.Label) {
+        auto lock = LockContainers();
+        return GetLabel(property.Name, value);
+    }
 
-            if (State == EContainerState::Stopped)
-                return TError(EError::InvalidState,
-                        "Not available in stopped state: " + property);
-            for (auto subsys: Subsystems) {
-                if (subsys->Type == type) {
-                    auto cg = GetCgroup(*subsys);
-                    if (!cg.Has(property))
-                        break;
-                    return cg.Get(property, value);
-                }
-            }
-            return TError(EError::InvalidProperty,
-                    "Unknown cgroup attribute: " + property);
+    if (!property.Controller.empty()) {
+        if (State == EContainerState::Stopped)
+            return TError(EError::InvalidState,
+                    "Not available in stopped state: " + property.Name);
+        if (property.Subsystem) {
+            auto cg = GetCgroup(*property.Subsystem);
+            if (cg.Has(property.Name))
+                return cg.Get(property.Name, value);
         }
-    } else if (!idx.length()) {
-        return TError(EError::InvalidProperty, "Empty property index");
+        return TError(EError::InvalidProperty,
+                "Unknown cgroup attribute: " + property.Name);
     }
 
-    auto it = ContainerProperties.find(property);
-    if (it == ContainerProperties.end())
+    if (property.Indexed && !property.Index.length())
+        return TError(EError::InvalidProperty, "Empty property index");
+
+    auto prop = property.Prop;
+    if (!prop)
         return TError(EError::InvalidProperty,
-                              "Unknown container property: " + property);
-    auto prop = it->second;
+                              "Unknown container property: " + property.Property);
 
     CT = const_cast<TContainer *>(this);
     error = prop->CanGet();
     if (!error) {
-        if (idx.length())
-            error = prop->GetIndexed(idx, value);
+        if (property.Indexed)
+            error = prop->GetIndexed(property.Index, value);
         else
             error = prop->Get(value);
     }
@@ -4244,7 +5055,7 @@ TError TContainer::SetProperty(const std::string &origProperty,
                 SetLabel(property, value);
                 lock.unlock();
                 TContainerWaiter::ReportAll(*this, property, value);
-                return Save();
+                return Save(false);
             }
         }
 
@@ -4288,7 +5099,7 @@ TError TContainer::SetProperty(const std::string &origProperty,
                 ClearProp(EProperty::EXTRA_PROPS);
         }
 
-        error = Save();
+        error = Save(false);
     }
 
     return error;
@@ -4312,18 +5123,67 @@ bool TContainer::MatchLabels(const rpc::TStringMap &labels) const {
     return matchLabels;
 }
 
-TError TContainer::Load(const rpc::TContainerSpec &spec, bool restoreOnError) {
+/*
+ * Checks if spec carries exactly current value of property.
+ * Fields dumped for property are returned even if value differs.
+ */
+static bool SpecValueUnchanged(const TProperty *prop, const rpc::TContainerSpec &spec,
+                               std::vector<std::string> &fields) {
+    std::vector<const google::protobuf::FieldDescriptor *> dumped;
+    rpc::TContainerSpec current, incoming;
+    google::protobuf::FieldMask mask;
+
+    fields.clear();
+
+    if (prop->CanGet())
+        return false;
+
+    prop->Dump(current);
+    current.GetReflection()->ListFields(current, &dumped);
+    if (dumped.empty())
+        return false;
+
+    for (auto field: dumped) {
+        fields.push_back(field->name());
+        mask.add_paths(field->name());
+    }
+
+    /* Compare only fields of this property, it must be found by them */
+    google::protobuf::util::FieldMaskUtil::MergeMessageTo(spec, mask,
+            google::protobuf::util::FieldMaskUtil::MergeOptions(), &incoming);
+
+    if (!prop->Has(incoming))
+        return false;
+
+    return incoming.SerializePartialAsString() == current.SerializePartialAsString();
+}
+
+/* With "changed" properties with unchanged values are skipped */
+TError TContainer::Load(const rpc::TContainerSpec &spec, bool restoreOnError,
+                        std::vector<std::string> *changed) {
+    std::vector<std::string> fields;
     TError error;
     rpc::TContainerSpec oldSpec;
+    bool updated = !changed;
 
     PORTO_ASSERT(!CT);
     CT = this;
     LockStateWrite();
-    ChangeTime = time(nullptr);
     for (auto &it :ContainerProperties) {
         auto prop = it.second;
         if (!prop->Has(spec))
             continue;
+        if (changed) {
+            /* Inherited value is pinned even if it is the same */
+            if (SpecValueUnchanged(prop, spec, fields) && HasProp(prop->Prop))
+                continue;
+            if (fields.empty())
+                fields.push_back(prop->Name);
+            for (auto &field: fields)
+                if (std::find(changed->begin(), changed->end(), field) == changed->end())
+                    changed->push_back(field);
+        }
+        updated = true;
         error = prop->CanSet();
         if (!error && prop->RequireControllers)
             error = EnableControllers(prop->RequireControllers);
@@ -4335,15 +5195,20 @@ TError TContainer::Load(const rpc::TContainerSpec &spec, bool restoreOnError) {
         if (error)
             break;
     }
+    if (updated)
+        ChangeTime = time(nullptr);
     SanitizeCapabilities();
     UnlockState();
     CT = nullptr;
 
+    if (!updated)
+        return error;
+
     if (!error && HasResources())
         error = ApplyDynamicProperties();
 
     if (!error)
-        error = Save();
+        error = Save(false);
 
     if (error && restoreOnError)
         Load(oldSpec, false);
@@ -4351,7 +5216,7 @@ TError TContainer::Load(const rpc::TContainerSpec &spec, bool restoreOnError) {
     return error;
 }
 
-void TContainer::Dump(const std::vector<std::string> &props, std::unordered_map<std::string, std::string> &propsOps, rpc::TContainer &spec) {
+void TContainer::Dump(const std::vector<TResolvedProperty> &props, rpc::TContainer &spec) {
     PORTO_ASSERT(!CT);
     CT = this;
     LockStateRead();
@@ -4367,26 +5232,24 @@ void TContainer::Dump(const std::vector<std::string> &props, std::unordered_map<
         }
     } else {
         for (auto &p: props) {
-            auto it = ContainerProperties.find(p);
-            if (it == ContainerProperties.end()) {
-                TError(EError::InvalidProperty, "Unknown property {}", p).Dump(*spec.mutable_status()->add_error());
+            auto prop = p.Prop;
+            if (!prop) {
+                TError(EError::InvalidProperty, "Unknown property {}", p.Name).Dump(*spec.mutable_status()->add_error());
                 continue;
             }
-            auto prop = it->second;
-            auto index = propsOps.find(prop->Name);
 
             if (!prop->CanGet()) {
                 if (prop->IsReadOnly) {
-                    if (index == propsOps.end())
+                    if (!p.Indexed)
                         prop->Dump(*spec.mutable_status());
                     else
-                        prop->DumpIndexed(index->second, *spec.mutable_status());
+                        prop->DumpIndexed(p.Index, *spec.mutable_status());
                 }
                 else {
-                    if (index == propsOps.end())
+                    if (!p.Indexed)
                         prop->Dump(*spec.mutable_spec());
                     else
-                        prop->DumpIndexed(index->second, *spec.mutable_spec());
+                        prop->DumpIndexed(p.Index, *spec.mutable_spec());
                 }
             }
         }
@@ -4395,7 +5258,7 @@ void TContainer::Dump(const std::vector<std::string> &props, std::unordered_map<
     CT = nullptr;
 }
 
-TError TContainer::Save(void) {
+TError TContainer::Save(bool sync) {
     TKeyValue node(ContainersKV / std::to_string(Id));
     TError error;
 
@@ -4432,7 +5295,7 @@ TError TContainer::Save(void) {
     if (error)
         return error;
 
-    return node.Save();
+    return KvStorage->Save(node.Data, sync);
 }
 
 TError TContainer::Load(const TKeyValue &node) {
@@ -4494,6 +5357,23 @@ TError TContainer::Load(const TKeyValue &node) {
     } else
         error = TError("Container has no state");
 
+    LoadControllers(node);
+
+    if (controllers & ~Controllers)
+        L_WRN("Missing cgroup controllers {}", TSubsystem::Format(controllers & ~Controllers));
+
+    if (!node.Has(P_OWNER_USER) || !node.Has(P_OWNER_GROUP))
+        OwnerCred = TaskCred;
+
+    SanitizeCapabilities();
+
+    UnlockState();
+    CT = nullptr;
+
+    return error;
+}
+
+void TContainer::LoadControllers(const TKeyValue &node) {
     if (!node.Has(P_CONTROLLERS) && State != EContainerState::Stopped)
         Controllers = RootContainer->Controllers;
 
@@ -4507,15 +5387,65 @@ TError TContainer::Load(const TKeyValue &node) {
         if (Cgroup2Subsystem.Supported)
             Controllers |= CGROUP2;
     }
+}
 
-    if (controllers & ~Controllers)
-        L_WRN("Missing cgroup controllers {}", TSubsystem::Format(controllers & ~Controllers));
+/*
+ * Minimal state for lazy restore: enough to list, find, check permissions,
+ * keep cgroups and age out container. Everything else is loaded by Load.
+ */
+static const std::vector<std::string> LazyHeaderProperties = {
+    P_OWNER_USER,
+    P_OWNER_GROUP,
+    P_USER,
+    P_GROUP,
+    P_VIRT_MODE,
+    P_CONTROLLERS,
+    P_LABELS,
+    P_WEAK,
+    P_AGING_TIME,
+    P_RAW_DEATH_TIME,
+    P_RAW_DESTROY_QUEUED,
+};
+
+TError TContainer::LoadHeader(const TKeyValue &node) {
+    EContainerState state = ParseState(node.Get(P_STATE));
+    TError error;
+
+    if (state != EContainerState::Stopped && state != EContainerState::Dead)
+        return TError(EError::InvalidState, "Cannot restore {} container lazily", node.Get(P_STATE));
+
+    CT = this;
+    LockStateWrite();
+
+    for (auto &key: LazyHeaderProperties) {
+        if (!node.Has(key))
+            continue;
+        auto prop = ContainerProperties.at(key);
+        error = prop->Load(node.Get(key));
+        if (error) {
+            L_ERR("Cannot load {} : {}", key, error);
+            break;
+        }
+        SetProp(prop->Prop);
+    }
+
+    if (node.Has(P_ROOT)) {
+        Root = node.Get(P_ROOT);
+        RootPath = Parent->RootPath / TPath(Root).NormalPath();
+    }
+
+    if (!error) {
+        UnlockState();
+        SetState(state);
+        LockStateWrite();
+        SetProp(EProperty::STATE);
+    }
+
+    LoadControllers(node);
 
     if (!node.Has(P_OWNER_USER) || !node.Has(P_OWNER_GROUP))
         OwnerCred = TaskCred;
 
-    SanitizeCapabilities();
-
     UnlockState();
     CT = nullptr;
 
@@ -4553,6 +5483,7 @@ TError TContainer::Seize() {
 
     if (SeizeTask.Pid) {
         SetProp(EProperty::SEIZE_PID);
+        IndexExitPids();
         return OK;
     }
 
@@ -4670,6 +5601,8 @@ void TContainer::SyncState() {
         RealDeathTime = time(nullptr);
         SetProp(EProperty::DEATH_TIME);
     }
+
+    IndexExitPids();
 }
 
 TError TContainer::SyncCgroups() {
@@ -4730,6 +5663,10 @@ TCgroup TContainer::GetCgroup(const TSubsystem &subsystem) const {
 TError TContainer::FreeCgroup(const TSubsystem &subsystem) {
     auto cg = GetCgroup(subsystem);
 
+    /* Removal of charged memcg is slow, do it in background */
+    if (Level == 1 && TCgroupPool::Trash(cg))
+        return OK;
+
     TError error = cg.Remove(); //Logged inside
     if (error && error.Errno != ENOENT)
         return error;
@@ -4786,15 +5723,22 @@ void TContainer::Event(const TEvent &event) {
     {
         bool delivered = false;
 
-        auto lock = LockContainers();
-        for (auto &it: Containers) {
-            if (it.second->WaitTask.Pid != event.Exit.Pid &&
-                    it.second->SeizeTask.Pid != event.Exit.Pid)
-                continue;
-            ct = it.second;
+        /* Master reports same exit later, that will be acked as unknown */
+        if (event.Exit.Pidfd) {
+            int status;
+            if (ct && !CL->LockContainer(ct)) {
+                if (ct->RecvExitStatus(event.Exit.Pid, status))
+                    ct->Exit(status, false);
+                CL->ReleaseContainer();
+            }
             break;
         }
-        lock.unlock();
+
+        /* Usually container is found when event is queued */
+        if (!ct) {
+            auto lock = LockContainers();
+            ct = FindByExitPid(event.Exit.Pid);
+        }
 
         if (ct && !CL->LockContainer(ct)) {
             if (ct->WaitTask.Pid == event.Exit.Pid ||
@@ -4855,17 +5799,7 @@ void TContainer::Event(const TEvent &event) {
 
     case EEventType::RotateLogs:
     {
-        for (auto &ct: RootContainer->Subtree()) {
-            if (ct->State == EContainerState::Dead &&
-                    GetCurrentTimeMs() >= ct->DeathTime + ct->AgingTime) {
-                TEvent ev(EEventType::DestroyAgedContainer, ct);
-                EventQueue->Add(0, ev);
-            }
-            if (ct->State == EContainerState::Running) {
-                ct->Stdout.Rotate(*ct);
-                ct->Stderr.Rotate(*ct);
-            }
-        }
+        TStdStream::RotateAll();
 
         struct stat st;
         if (!StdLog && LogFile && !LogFile.Stat(st) && !st.st_nlink)
@@ -3,9 +3,11 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <unordered_map>
 #include <memory>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 
 #include "util/unix.hpp"
 #include "util/task.hpp"
@@ -26,6 +28,8 @@ class TClient;
 class TVolume;
 class TVolumeLink;
 class TKeyValue;
+class TKeyValueStorage;
+class THistogram;
 struct TBindMount;
 class TVmStat;
 
@@ -68,24 +72,49 @@ struct ExtraProperty {
     std::vector<Property> Properties;
 };
 
+enum class ESubtreeOrder {
+    Any,
+    ChildsFirst,
+    ParentsFirst,
+};
+
 class TProperty;
 
+/* Property name parsed once per request and reused for each container */
+struct TResolvedProperty {
+    std::string Name;       /* as requested */
+    std::string Property;   /* without index */
+    std::string Index;
+    bool Indexed = false;
+    bool Label = false;
+    std::string Controller; /* for "controller.knob" */
+    TSubsystem *Subsystem = nullptr;
+    TProperty *Prop = nullptr;
+};
+
 class TContainer : public std::enable_shared_from_this<TContainer>,
                    public TNonCopyable {
     friend class TProperty;
 
+    /* Protected with lock shard, root container uses all shards */
     int StateLocked = 0;
     int ActionLocked = 0;
-    int SubtreeRead = 0;
-    int SubtreeWrite = 0;
+    std::atomic<int> SubtreeRead{0};  /* root counters are shared by all shards */
+    std::atomic<int> SubtreeWrite{0};
     bool PendingWrite = false;
     pid_t LastStatePid = 0;
     pid_t LastActionPid = 0;
 
     TFile OomEvent;
+    TFile Cgroup2Dir;   /* cached for clone3 into cgroup */
 
     std::shared_ptr<TEpollSource> Source;
 
+    TFile WaitPidfd;    /* readable when WaitTask exits */
+    std::shared_ptr<TEpollSource> ExitSource;
+
+    TError LockActionShard(bool shared);
+
     // data
     TError UpdateSoftLimit();
     void SetState(EContainerState next);
@@ -97,6 +126,8 @@ class TContainer : public std::enable_shared_from_this<TContainer>,
     TError ApplyDynamicProperties(bool onRestore = false);
     TError PrepareOomMonitor();
     void ShutdownOom();
+    void TrackExit();
+    void UntrackExit();
     TError PrepareCgroups();
     TError PrepareTask(TTaskEnv &TaskEnv);
 
@@ -104,7 +135,8 @@ class TContainer : public std::enable_shared_from_this<TContainer>,
     TError FreeResources(bool ignore = true);
 
     TError PrepareRuntimeResources();
-    void FreeRuntimeResources();
+    void FreeRuntimeResources(bool parents = true);
+    void FreeParentResources();
 
     void Reap(bool oomKilled);
     void Exit(int status, bool oomKilled);
@@ -134,6 +166,7 @@ public:
     const int Id;
     const std::string Name;
     const std::string FirstName;
+    const int Shard; /* lock shard, common for first level subtree */
 
     EContainerState State = EContainerState::Stopped;
     std::atomic<int> RunningChildren;
@@ -170,6 +203,9 @@ public:
     TStdStream Stdin, Stdout, Stderr;
     std::string Root;
     bool RootRo;
+    std::string WarmTemplate;
+    TPath WarmRoot;             /* claimed warm volume, root until stop */
+    TFile WarmNetns;            /* claimed from warm pool, used once at start */
     mode_t Umask;
     bool BindDns = false;       /* deprecated */
     bool Isolate;               /* New pid/ipc/utc/env namespace */
@@ -218,6 +254,17 @@ public:
     uint64_t AgingTime;
     uint64_t ChangeTime = 0;
 
+    /* Duration of last start phases in microseconds */
+    std::vector<std::pair<std::string, uint64_t>> StartTimings;
+    void AddStartTiming(const std::string &phase, uint64_t timeUs);
+    std::vector<std::pair<std::string, uint64_t>> GetStartTimings() const;
+    static std::vector<std::pair<std::string, std::shared_ptr<THistogram>>> StartTimingHgrams();
+
+    std::shared_ptr<TKeyValueStorage> KvStorage;
+
+    /* Restored from header, rest of key-value node is not loaded yet */
+    std::atomic<bool> Lazy{false};
+
     TUlimit Ulimit;
 
     std::string NsName;
@@ -281,6 +328,7 @@ public:
     TError MayRespawn();
     TError Respawn();
     TError ScheduleRespawn();
+    void ScheduleAging();
 
     TStringMap Labels;
     std::string Private;
@@ -289,6 +337,7 @@ public:
     std::atomic<uint64_t> ContainerRequests;
 
     bool IsWeak = false;
+    bool DestroyQueued = false; /* protected by ContainersMutex */
     bool OomIsFatal = true;
     int OomScoreAdj = 0;
     std::atomic<uint64_t> OomEvents;
@@ -306,6 +355,7 @@ public:
     } TaintFlags;
 
     bool RecvOomEvents();
+    bool RecvExitStatus(pid_t pid, int &status);
 
     TPath RootPath; /* path in host namespace */
     std::vector<std::string> PlacePolicy;
@@ -384,7 +434,7 @@ public:
     TError LockActionShared(std::unique_lock<std::mutex> &containers_lock) {
         return LockAction(containers_lock, true);
     }
-    void UnlockAction(bool containers_locked = false);
+    void UnlockAction();
     bool IsActionLocked(bool shared = false);
     void DowngradeActionLock();
     void UpgradeActionLock();
@@ -412,10 +462,16 @@ public:
 
     bool IsRoot() const { return !Level; }
     bool IsChildOf(const TContainer &ct) const;
+    bool IsDestroyQueued() const;
+    static void DestroyQueuedContainer(std::shared_ptr<TContainer> ct);
 
     std::list<std::shared_ptr<TContainer>> Subtree();
     std::list<std::shared_ptr<TContainer>> Childs();
 
+    static TError ForEachParallel(const std::list<std::shared_ptr<TContainer>> &cts,
+                                  ESubtreeOrder order, unsigned threads,
+                                  const std::function<TError(std::shared_ptr<TContainer> &)> &action);
+
     std::shared_ptr<TContainer> GetParent() const;
 
     bool HasPidFor(const TContainer &ct) const;
@@ -428,6 +484,8 @@ public:
 
     TError StartTask();
     TError StartParents();
+    void SetWarmRoot(const TPath &path);
+    TError PrepareWarmRoot();
     TError PrepareStart();
     TError Start();
 
@@ -437,6 +495,9 @@ public:
     TError Terminate(uint64_t deadline);
     TError Kill(int sig);
     TError Destroy(std::list<std::shared_ptr<TVolume>> &unlinked);
+    TError DestroyAsync();
+    static void StartDestroyReaper();
+    static void StopDestroyReaper();
 
     /* Refresh cached counters */
     void SyncProperty(const std::string &name);
@@ -446,14 +507,22 @@ public:
     TError SetSymlink(const TPath &symlink, const TPath &target);
 
     TError EnableControllers(uint64_t controllers);
+    static void ResolveProperty(const std::string &name, TResolvedProperty &property);
+    static void ResolveDumpProperties(const std::vector<std::string> &names,
+                                      const std::unordered_map<std::string, std::string> &indexes,
+                                      std::vector<TResolvedProperty> &properties);
+
     TError HasProperty(const std::string &property) const;
+    TError HasProperty(const TResolvedProperty &property) const;
     TError GetProperty(const std::string &property, std::string &value) const;
+    TError GetProperty(const TResolvedProperty &property, std::string &value) const;
     TError SetProperty(const std::string &property, const std::string &value);
 
     bool MatchLabels(const rpc::TStringMap &labels) const;
 
-    TError Load(const rpc::TContainerSpec &spec, bool restoreOnError = false);
-    void Dump(const std::vector<std::string> &props, std::unordered_map<std::string, std::string> &propsOps, rpc::TContainer &spec);
+    TError Load(const rpc::TContainerSpec &spec, bool restoreOnError = false,
+                std::vector<std::string> *changed = nullptr);
+    void Dump(const std::vector<TResolvedProperty> &props, rpc::TContainer &spec);
 
     /* Protected with ContainersLock */
     static TError ValidLabel(const std::string &label, const std::string &value);
@@ -462,12 +531,21 @@ public:
     TError IncLabel(const std::string &label, int64_t &result, int64_t add = 1);
 
     void ForgetPid();
+    void IndexExitPids();
     void SyncState();
     TError Seize();
     TError SyncCgroups();
 
-    TError Save(void);
+    /* Sync save writes at once, otherwise it could be delayed and coalesced */
+    TError Save(bool sync = true);
     TError Load(const TKeyValue &node);
+    TError LoadHeader(const TKeyValue &node);
+    void LoadControllers(const TKeyValue &node);
+
+    /* Finish lazy restore, caller holds action lock */
+    TError RestoreLazy();
+    /* Finish lazy restore, takes action lock */
+    TError LoadLazy();
 
     TCgroup GetCgroup(const TSubsystem &subsystem) const;
     TError FreeCgroup(const TSubsystem &subsystem);
@@ -495,10 +573,12 @@ public:
 
     static std::shared_ptr<TContainer> Find(const std::string &name, bool strict = true);
     static TError Find(const std::string &name, std::shared_ptr<TContainer> &ct, bool strict = true);
+    static std::shared_ptr<TContainer> FindById(int id);
+    static std::shared_ptr<TContainer> FindByExitPid(pid_t pid);
     static TError FindTaskContainer(pid_t pid, std::shared_ptr<TContainer> &ct, bool strict = true);
 
     static TError Create(const std::string &name, std::shared_ptr<TContainer> &ct);
-    static TError Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct);
+    static TError Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct, bool lazy = false);
 
     static void Event(const TEvent &event);
 
@@ -516,7 +596,9 @@ public:
 
 extern MeasuredMutex ContainersMutex;
 extern std::shared_ptr<TContainer> RootContainer;
-extern std::map<std::string, std::shared_ptr<TContainer>> Containers;
+/* Unordered, sort results where output order matters */
+extern std::unordered_map<std::string, std::shared_ptr<TContainer>> Containers;
+extern std::vector<std::shared_ptr<TContainer>> ContainersById;
 extern TPath ContainersKV;
 extern TIdMap ContainerIdMap;
 
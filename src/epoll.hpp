@@ -7,6 +7,7 @@
 #include "util/locks.hpp"
 
 constexpr int EPOLL_EVENT_OOM = 1;
+constexpr int EPOLL_EVENT_EXIT = 2;
 
 class TContainer;
 class TEpollLoop;
@@ -3,46 +3,44 @@
 #include "util/log.hpp"
 #include "util/unix.hpp"
 #include "util/worker.hpp"
+#include "util/hgram.hpp"
 #include "container.hpp"
 #include "client.hpp"
 
-class TEventWorker : public TWorker<TEvent, std::priority_queue<TEvent>> {
+static constexpr int EVENT_TYPES = (int)EEventType::DestroyWeakContainer + 1;
+
+static const std::vector<unsigned> EventDelayBuckets = {
+    0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, 60000
+};
+
+static std::shared_ptr<THistogram> EventDelayHgram[EVENT_TYPES];
+
+/* Events for the same container are handled by one worker in order */
+class TEventWorker : public TWorker<TEvent> {
 public:
-    TEventWorker(const size_t nr) : TWorker("portod-EV", nr), client("<event>") {}
+    TEventWorker(const std::string &name) : TWorker(name, 1), client("<event>") {}
 
     TClient client;
 
-    const TEvent &Top() override {
-        return Queue.top();
+    void Start() {
+        Threads.push_back(std::shared_ptr<std::thread>(NewThread(&TWorker::WorkerFn, this, Name)));
     }
 
-    void Wait(TScopedLock &lock) override {
-        if (!Valid)
-            return;
-
-        Statistics->QueuedEvents = Queue.size();
-
-        if (Queue.size()) {
-            auto now = GetCurrentTimeMs();
-            if (Top().DueMs <= now)
-                return;
-            auto timeout = Top().DueMs - now;
-            Cv.wait_for(lock, std::chrono::milliseconds(timeout));
-        } else {
-            TWorker::Wait(lock);
-        }
+    const TEvent &Top() override {
+        return Queue.front();
     }
 
     bool Handle(const TEvent &event) override {
-        if (event.DueMs <= GetCurrentTimeMs()) {
-            client.ClientContainer = RootContainer;
-            client.StartRequest();
-            TContainer::Event(event);
-            client.FinishRequest();
-            return true;
-        }
+        uint64_t now = GetCurrentTimeMs();
+        EventDelayHgram[(int)event.Type]->Add(now > event.DueMs ? now - event.DueMs : 0);
+
+        client.ClientContainer = RootContainer;
+        client.StartRequest();
+        TContainer::Event(event);
+        client.FinishRequest();
 
-        return false;
+        Statistics->QueuedEvents--;
+        return true;
     }
 };
 
@@ -71,24 +69,231 @@ std::string TEvent::GetMsg() const {
     }
 }
 
-bool TEvent::operator<(const TEvent& rhs) const {
-    return DueMs >= rhs.DueMs;
+std::string TEvent::TypeName(EEventType type) {
+    switch (type) {
+        case EEventType::Exit:
+            return "exit";
+        case EEventType::ChildExit:
+            return "child_exit";
+        case EEventType::RotateLogs:
+            return "rotate_logs";
+        case EEventType::Respawn:
+            return "respawn";
+        case EEventType::OOM:
+            return "oom";
+        case EEventType::WaitTimeout:
+            return "wait_timeout";
+        case EEventType::DestroyAgedContainer:
+            return "destroy_aged";
+        case EEventType::DestroyWeakContainer:
+            return "destroy_weak";
+        default:
+            return "unknown";
+    }
+}
+
+void TTimerWheel::Place(const TEvent &e, std::vector<TEvent> &expired) {
+    if (e.DueMs <= Now) {
+        expired.push_back(e);
+        return;
+    }
+
+    int level = 0;
+    uint64_t slot = e.DueMs;
+
+    /* Choose lowest level where event fits into one turn */
+    while ((slot - (Now >> (level * BITS))) >= SLOTS) {
+        if (level == LEVELS - 1) {
+            /* Too far, park in last slot and cascade later */
+            slot = (Now >> (level * BITS)) + MASK;
+            break;
+        }
+        level++;
+        slot = e.DueMs >> (level * BITS);
+    }
+
+    Slots[level][slot & MASK].push_back(e);
+    LevelCount[level]++;
+    Count++;
+}
+
+void TTimerWheel::Add(const TEvent &e, std::vector<TEvent> &expired) {
+    Place(e, expired);
+}
+
+void TTimerWheel::Advance(uint64_t now, std::vector<TEvent> &expired) {
+    while (Now < now) {
+        uint64_t next = Now + 1;
+
+        /* Nothing could expire before next cascade of lowest used level */
+        if (!LevelCount[0]) {
+            int level = 1;
+            while (level < LEVELS && !LevelCount[level])
+                level++;
+            if (level == LEVELS) {
+                Now = now;
+                break;
+            }
+            int shift = level * BITS;
+            next = std::min(((Now >> shift) + 1) << shift, now);
+        }
+
+        Now = next;
+
+        for (int level = LEVELS - 1; level > 0; level--) {
+            int shift = level * BITS;
+            if (Now & ((1ull << shift) - 1))
+                continue;
+            auto &slot = Slots[level][(Now >> shift) & MASK];
+            if (slot.empty())
+                continue;
+            std::vector<TEvent> events;
+            events.swap(slot);
+            LevelCount[level] -= events.size();
+            Count -= events.size();
+            for (auto &e: events)
+                Place(e, expired);
+        }
+
+        auto &slot = Slots[0][Now & MASK];
+        if (!slot.empty()) {
+            LevelCount[0] -= slot.size();
+            Count -= slot.size();
+            expired.insert(expired.end(), slot.begin(), slot.end());
+            slot.clear();
+        }
+    }
+}
+
+uint64_t TTimerWheel::NextDue() const {
+    uint64_t due = UINT64_MAX;
+
+    if (LevelCount[0]) {
+        for (uint64_t time = Now + 1; time <= Now + MASK; time++) {
+            if (!Slots[0][time & MASK].empty()) {
+                due = time;
+                break;
+            }
+        }
+    }
+
+    for (int level = 1; level < LEVELS; level++) {
+        if (LevelCount[level]) {
+            int shift = level * BITS;
+            due = std::min(due, ((Now >> shift) + 1) << shift);
+            break;
+        }
+    }
+
+    return due;
+}
+
+TEventQueue::TEventQueue() : Wheel(GetCurrentTimeMs()) {
+    unsigned workers = std::max(config().daemon().event_worker_threads(), 1u);
+
+    for (unsigned i = 0; i < workers; i++)
+        Workers.push_back(std::make_shared<TEventWorker>("portod-EV" + std::to_string(i)));
+
+    for (int type = 0; type < EVENT_TYPES; type++) {
+        if (!EventDelayHgram[type])
+            EventDelayHgram[type] = std::make_shared<THistogram>(EventDelayBuckets);
+    }
+}
+
+void TEventQueue::Dispatch(const TEvent &e) {
+    auto ct = e.Container.lock();
+    size_t shard = ct ? ct->Id % Workers.size() : 0;
+    Workers[shard]->Push(e);
+}
+
+void TEventQueue::TimerLoop() {
+    std::vector<TEvent> expired;
+
+    SetProcessName("portod-EVT");
+
+    std::unique_lock<std::mutex> lock(Mutex);
+    while (Valid) {
+        uint64_t now = GetCurrentTimeMs();
+
+        Wheel.Advance(now, expired);
+        if (!expired.empty()) {
+            lock.unlock();
+            for (auto &e: expired)
+                Dispatch(e);
+            expired.clear();
+            lock.lock();
+            continue;
+        }
+
+        uint64_t due = Wheel.NextDue();
+        if (due == UINT64_MAX)
+            Cv.wait(lock);
+        else if (due > now)
+            Cv.wait_for(lock, std::chrono::milliseconds(due - now));
+    }
 }
 
 void TEventQueue::Add(uint64_t timeoutMs, const TEvent &e) {
     TEvent copy = e;
     copy.DueMs = GetCurrentTimeMs() + timeoutMs;
-    Worker->Push(copy);
-}
 
-TEventQueue::TEventQueue() {
-    Worker = std::make_shared<TEventWorker>(1);
+    /* Route exit to worker of its container to keep order with other events */
+    if ((copy.Type == EEventType::Exit || copy.Type == EEventType::ChildExit) &&
+            copy.Container.expired()) {
+        auto lock = LockContainers();
+        auto ct = TContainer::FindByExitPid(copy.Exit.Pid);
+        if (ct)
+            copy.Container = ct;
+    }
+
+    Statistics->QueuedEvents++;
+
+    if (!timeoutMs) {
+        Dispatch(copy);
+        return;
+    }
+
+    std::vector<TEvent> expired;
+    std::unique_lock<std::mutex> lock(Mutex);
+    bool wakeup = copy.DueMs < Wheel.NextDue();
+    Wheel.Add(copy, expired);
+    lock.unlock();
+
+    for (auto &ev: expired)
+        Dispatch(ev);
+
+    if (wakeup)
+        Cv.notify_one();
 }
 
 void TEventQueue::Start() {
-    Worker->Start();
+    for (auto &worker: Workers)
+        worker->Start();
+    TimerThread = std::unique_ptr<std::thread>(NewThread(&TEventQueue::TimerLoop, this));
 }
 
 void TEventQueue::Stop() {
-    Worker->Stop();
+    std::unique_lock<std::mutex> lock(Mutex);
+    Valid = false;
+    Cv.notify_all();
+    lock.unlock();
+
+    if (TimerThread) {
+        TimerThread->join();
+        TimerThread = nullptr;
+    }
+
+    for (auto &worker: Workers)
+        worker->Stop();
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<THistogram>>> TEventQueue::DelayHgrams() {
+    std::vector<std::pair<std::string, std::shared_ptr<THistogram>>> hgrams;
+
+    for (int type = 0; type < EVENT_TYPES; type++) {
+        if (EventDelayHgram[type])
+            hgrams.emplace_back(TEvent::TypeName((EEventType)type), EventDelayHgram[type]);
+    }
+
+    return hgrams;
 }
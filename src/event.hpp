@@ -2,6 +2,10 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include "util/worker.hpp"
 
@@ -20,6 +24,7 @@ enum class EEventType {
 };
 
 class TEventWorker;
+class THistogram;
 
 class TEvent {
 public:
@@ -29,6 +34,7 @@ public:
     struct {
         int Pid = 0;
         int Status = 0;
+        bool Pidfd = false;     /* status isn't known, master isn't acked */
     } Exit;
 
     struct {
@@ -40,13 +46,52 @@ public:
     TEvent(EEventType type, std::shared_ptr<TContainer> container = nullptr) :
         Type(type), Container(container) {}
 
-    bool operator<(const TEvent& rhs) const;
-
     std::string GetMsg() const;
+    static std::string TypeName(EEventType type);
+};
+
+/*
+ * Hierarchical timer wheel with millisecond resolution.
+ * Level N slot covers 64^N ms, farther events are cascaded down.
+ */
+class TTimerWheel {
+    static constexpr int LEVELS = 6;
+    static constexpr int BITS = 6;
+    static constexpr int SLOTS = 1 << BITS;
+    static constexpr uint64_t MASK = SLOTS - 1;
+
+    uint64_t Now;
+    size_t Count = 0;
+    size_t LevelCount[LEVELS] = {};
+    std::vector<TEvent> Slots[LEVELS][SLOTS];
+
+    void Place(const TEvent &e, std::vector<TEvent> &expired);
+
+public:
+    TTimerWheel(uint64_t now) : Now(now) {}
+
+    size_t Size() const { return Count; }
+
+    /* Event is added into expired if it is already due */
+    void Add(const TEvent &e, std::vector<TEvent> &expired);
+
+    /* Moves events which are due at or before now into expired */
+    void Advance(uint64_t now, std::vector<TEvent> &expired);
+
+    /* Time when wheel must be advanced next, UINT64_MAX if empty */
+    uint64_t NextDue() const;
 };
 
 class TEventQueue {
-    std::shared_ptr<TEventWorker> Worker;
+    std::mutex Mutex;
+    std::condition_variable Cv;
+    bool Valid = true;
+    TTimerWheel Wheel;
+    std::unique_ptr<std::thread> TimerThread;
+    std::vector<std::shared_ptr<TEventWorker>> Workers;
+
+    void TimerLoop();
+    void Dispatch(const TEvent &e);
 
 public:
     TEventQueue();
@@ -54,4 +99,7 @@ public:
     void Stop();
 
     void Add(uint64_t timeoutMs, const TEvent &e);
+
+    /* Queue delay histograms by event type */
+    static std::vector<std::pair<std::string, std::shared_ptr<THistogram>>> DelayHgrams();
 };
@@ -1,9 +1,11 @@
 #include "helpers.hpp"
 #include "common.hpp"
 #include "client.hpp"
+#include "config.hpp"
 #include "util/path.hpp"
 #include "util/log.hpp"
 #include "util/unix.hpp"
+#include "util/zygote.hpp"
 
 extern "C" {
 #include <unistd.h>
@@ -31,63 +33,39 @@ TError RunCommand(const std::vector<std::string> &command,
     return RunCommand(command, {}, dir, in, out, caps, PORTO_HELPERS_CGROUP, verboseError, interruptible);
 }
 
-TError RunCommand(const std::vector<std::string> &command,
-                  const std::vector<std::string> &env,
-                  const TFile &dir, const TFile &in, const TFile &out,
-                  const TCapabilities &caps,
-                  const std::string &memCgroup,
-                  bool verboseError,
-                  bool interruptible) {
-    TCgroup memcg = MemorySubsystem.Cgroup(memCgroup);
-    TError error;
-    TFile err;
-    TTask task;
-    TPath path = dir.RealPath();
-
-    if (!command.size())
-        return TError("External command is empty");
-
-    error = err.CreateUnnamed("/tmp", O_APPEND);
-    if (error)
-        return error;
-
-    std::string cmdline;
+static TError HelperResult(TError error, TFile &err, const std::string &cmdline,
+                           bool verboseError) {
+    if (error && error == EError::Unknown) {
+        std::string text;
+        TError error2 = err.ReadEnds(text, TError::MAX_LENGTH - 1024);
+        if (error2)
+            text = "Cannot read stderr: " + error2.ToString();
+
+        if (verboseError) {
+            error.Error = EError::HelperError;
+            if (text.find("not recoverable") != std::string::npos)
+                error.Error = EError::HelperFatalError;
+        }
 
-    for (auto &arg : command) {
-        if (!StringStartsWith(arg, "--header=Authorization"))
-            cmdline += arg + " ";
-        else
-            cmdline += "--header=Authorization: *** ";
+        error = TError(error, "helper: {} stderr: {}", cmdline, text);
     }
+    return error;
+}
 
-    L_ACT("Call helper: {} in {}", cmdline, path);
-
-    error = task.Fork();
-    if (error)
-        return error;
-
-    if (task.Pid) {
-        if (interruptible && CL)
-            error = task.Wait(interruptible, NeedStopHelpers, CL->Closed);
-        else
-            error = task.Wait(interruptible, NeedStopHelpers);
-
-        if (error && error == EError::Unknown) {
-            std::string text;
-            TError error2 = err.ReadEnds(text, TError::MAX_LENGTH - 1024);
-            if (error2)
-                text = "Cannot read stderr: " + error2.ToString();
-
-            if (verboseError) {
-                error.Error = EError::HelperError;
-                if (text.find("not recoverable") != std::string::npos)
-                    error.Error = EError::HelperFatalError;
-            }
-
-            error = TError(error, "helper: {} stderr: {}", cmdline, text);
-        }
-        return error;
-    }
+static void RunCommandChild(const std::vector<std::string> &command,
+                            const std::vector<std::string> &env,
+                            const TFile &dir, const TPath &path,
+                            const TFile &in, const TFile &out, TFile &err,
+                            const TCapabilities &caps,
+                            const TCgroup &memcg) __attribute__ ((noreturn));
+
+static void RunCommandChild(const std::vector<std::string> &command,
+                            const std::vector<std::string> &env,
+                            const TFile &dir, const TPath &path,
+                            const TFile &in, const TFile &out, TFile &err,
+                            const TCapabilities &caps,
+                            const TCgroup &memcg) {
+    TError error;
 
     SetProcessName("portod-" + command[0]);
 
@@ -180,6 +158,150 @@ TError RunCommand(const std::vector<std::string> &command,
     HelperError(err, fmt::format("Cannot execute {}", argv[0]), TError::System("exec"));
 }
 
+TZygote HelpersZygote;
+
+/*
+ * Request: memory cgroup, permitted capabilities, real path of dir,
+ * flags of passed fds "i", "o", "d", count of env, env, command.
+ * Fds: stderr, then stdin, stdout, dir if passed.
+ */
+static void ZygoteHandler(const std::vector<std::string> &args,
+                          const std::vector<int> &fds) {
+    std::vector<std::string> env, command;
+    TCapabilities caps;
+    TFile in, out, err, dir;
+    uint64_t count;
+    size_t fd = 0;
+
+    if (args.size() < 5 || fds.empty())
+        _exit(EXIT_FAILURE);
+
+    err.SetFd = fds[fd++];
+
+    std::string flags = args[3];
+    if (flags.find('i') != std::string::npos && fd < fds.size())
+        in.SetFd = fds[fd++];
+    if (flags.find('o') != std::string::npos && fd < fds.size())
+        out.SetFd = fds[fd++];
+    if (flags.find('d') != std::string::npos && fd < fds.size())
+        dir.SetFd = fds[fd++];
+
+    if (StringToUint64(args[1], caps.Permitted) ||
+            StringToUint64(args[4], count) || 5 + count >= args.size())
+        HelperError(err, "Cannot parse zygote request", TError(EError::InvalidValue, "bad request"));
+
+    env.assign(args.begin() + 5, args.begin() + 5 + count);
+    command.assign(args.begin() + 5 + count, args.end());
+
+    RunCommandChild(command, env, dir, TPath(args[2]), in, out, err,
+                    caps, MemorySubsystem.Cgroup(args[0]));
+}
+
+TError StartHelpersZygote() {
+    if (!config().daemon().helpers_zygote())
+        return OK;
+    return HelpersZygote.Start(ZygoteHandler);
+}
+
+void StopHelpersZygote() {
+    HelpersZygote.Stop();
+}
+
+static TError SpawnHelper(const std::vector<std::string> &command,
+                          const std::vector<std::string> &env,
+                          const TFile &dir, const TPath &path,
+                          const TFile &in, const TFile &out, const TFile &err,
+                          const TCapabilities &caps,
+                          const std::string &memCgroup,
+                          TZygoteTask &task) {
+    std::vector<std::string> args = {
+        memCgroup,
+        std::to_string(caps.Permitted),
+        path.ToString(),
+        "",
+        std::to_string(env.size()),
+    };
+    std::vector<int> fds = { err.Fd };
+
+    if (in) {
+        args[3] += "i";
+        fds.push_back(in.Fd);
+    }
+    if (out) {
+        args[3] += "o";
+        fds.push_back(out.Fd);
+    }
+    if (dir) {
+        args[3] += "d";
+        fds.push_back(dir.Fd);
+    }
+
+    args.insert(args.end(), env.begin(), env.end());
+    args.insert(args.end(), command.begin(), command.end());
+
+    return HelpersZygote.Spawn(args, fds, task);
+}
+
+TError RunCommand(const std::vector<std::string> &command,
+                  const std::vector<std::string> &env,
+                  const TFile &dir, const TFile &in, const TFile &out,
+                  const TCapabilities &caps,
+                  const std::string &memCgroup,
+                  bool verboseError,
+                  bool interruptible) {
+    TCgroup memcg = MemorySubsystem.Cgroup(memCgroup);
+    TError error;
+    TFile err;
+    TTask task;
+    TPath path = dir.RealPath();
+
+    if (!command.size())
+        return TError("External command is empty");
+
+    error = err.CreateUnnamed("/tmp", O_APPEND);
+    if (error)
+        return error;
+
+    std::string cmdline;
+
+    for (auto &arg : command) {
+        if (!StringStartsWith(arg, "--header=Authorization"))
+            cmdline += arg + " ";
+        else
+            cmdline += "--header=Authorization: *** ";
+    }
+
+    L_ACT("Call helper: {} in {}", cmdline, path);
+
+    if (HelpersZygote) {
+        TZygoteTask ztask;
+
+        error = SpawnHelper(command, env, dir, path, in, out, err, caps, memCgroup, ztask);
+        if (!error) {
+            if (interruptible && CL)
+                error = ztask.Wait(interruptible, NeedStopHelpers, CL->Closed);
+            else
+                error = ztask.Wait(interruptible, NeedStopHelpers);
+            return HelperResult(error, err, cmdline, verboseError);
+        }
+        L_WRN("Cannot spawn helper via zygote: {}", error);
+    }
+
+    error = task.Fork();
+    if (error)
+        return error;
+
+    if (task.Pid) {
+        if (interruptible && CL)
+            error = task.Wait(interruptible, NeedStopHelpers, CL->Closed);
+        else
+            error = task.Wait(interruptible, NeedStopHelpers);
+        return HelperResult(error, err, cmdline, verboseError);
+    }
+
+    RunCommandChild(command, env, dir, path, in, out, err, caps, memcg);
+}
+
 TError CopyRecursive(const TPath &src, const TPath &dst) {
     TError error;
     TPathWalk walk;
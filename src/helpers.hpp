@@ -20,6 +20,10 @@ TError RunCommand(const std::vector<std::string> &command,
                   bool verboseError = false,
                   bool interruptible = false);
 
+/* Forks helpers from zygote if enabled in config */
+TError StartHelpersZygote();
+void StopHelpersZygote();
+
 TError CopyRecursive(const TPath &src, const TPath &dst);
 TError ClearRecursive(const TPath &path);
 TError RemoveRecursive(const TPath &path, bool interruptible = false);
@@ -2,7 +2,10 @@
 #include "config.hpp"
 #include "kv.pb.h"
 #include "util/log.hpp"
+#include "util/unix.hpp"
+#include "util/thread.hpp"
 
+#include <condition_variable>
 #include <google/protobuf/io/coded_stream.h>
 
 extern "C" {
@@ -21,15 +24,28 @@ TError TKeyValue::Load() {
 
     ssize_t size = buf.size();
     google::protobuf::io::CodedInputStream input((uint8_t *)&buf[0], size);
+    int records = 0;
 
     while (size) {
         uint32_t len;
 
-        if (!input.ReadVarint32(&len))
-            return TError("KeyValue: corrupted storage");
+        /* Delta appended by SaveDelta could be cut short, even its length */
+        if (!input.ReadVarint32(&len)) {
+            if (!records)
+                return TError("KeyValue: corrupted storage");
+            L_WRN("KeyValue: ignore truncated record in {}", Path);
+            break;
+        }
 
         size -= google::protobuf::io::CodedOutputStream::VarintSize32(len);
+
+        if (records && (ssize_t)len > size) {
+            L_WRN("KeyValue: ignore truncated record in {}", Path);
+            break;
+        }
+
         size -= len;
+        records++;
 
         node.Clear();
         auto limit = input.PushLimit(len);
@@ -46,17 +62,7 @@ TError TKeyValue::Load() {
     return OK;
 }
 
-TError TKeyValue::Save() {
-    std::string buf;
-    kv::TNode node;
-    TError error;
-
-    for (const auto &pair: Data) {
-        auto kv = node.add_pairs();
-        kv->set_key(pair.first);
-        kv->set_val(pair.second);
-    }
-
+static TError SerializeRecord(const kv::TNode &node, std::string &buf) {
     uint32_t len = node.ByteSize();
     size_t lenLen = google::protobuf::io::CodedOutputStream::VarintSize32(len);
 
@@ -69,6 +75,24 @@ TError TKeyValue::Save() {
     if (!node.SerializeToArray((uint8_t *)&buf[lenLen], len))
         return TError("KeyValue: cannot serialize");
 
+    return OK;
+}
+
+TError TKeyValue::Save() {
+    std::string buf;
+    kv::TNode node;
+    TError error;
+
+    for (const auto &pair: Data) {
+        auto kv = node.add_pairs();
+        kv->set_key(pair.first);
+        kv->set_val(pair.second);
+    }
+
+    error = SerializeRecord(node, buf);
+    if (error)
+        return error;
+
     TPath tmpPath(Path.ToString() + ".tmp");
     error = tmpPath.Mkfile(0640);
     if (!error)
@@ -78,12 +102,174 @@ TError TKeyValue::Save() {
     if (!error)
         error = tmpPath.Rename(Path);
 
-    if (error)
+    if (error) {
         (void)tmpPath.Unlink();
+        StoredSize = 0;
+    } else {
+        Stored = Data;
+        StoredSize = CompactSize = buf.size();
+    }
 
     return error;
 }
 
+/*
+ * Append record with changed keys, Load merges records in order.
+ * Falls back to Save when file is unknown, keys are removed or
+ * file grows above keyvalue_compact_ratio times its compacted size.
+ */
+TError TKeyValue::SaveDelta() {
+    uint64_t ratio = config().keyvalue_compact_ratio();
+    std::string buf;
+    kv::TNode node;
+    TError error;
+
+    if (!StoredSize || !ratio)
+        return Save();
+
+    for (const auto &pair: Stored) {
+        if (!Data.count(pair.first))
+            return Save();
+    }
+
+    for (const auto &pair: Data) {
+        auto it = Stored.find(pair.first);
+        if (it != Stored.end() && it->second == pair.second)
+            continue;
+        auto kv = node.add_pairs();
+        kv->set_key(pair.first);
+        kv->set_val(pair.second);
+    }
+
+    if (!node.pairs_size())
+        return OK;
+
+    error = SerializeRecord(node, buf);
+    if (error)
+        return error;
+
+    if (StoredSize + buf.size() > CompactSize * ratio ||
+            StoredSize + buf.size() > config().keyvalue_limit())
+        return Save();
+
+    TFile file;
+    error = file.OpenAppend(Path);
+    if (!error)
+        error = file.WriteAll(buf);
+    if (error) {
+        L_WRN("KeyValue: cannot append {}: {}", Path, error);
+        return Save();
+    }
+
+    for (const auto &pair: node.pairs())
+        Stored[pair.key()] = pair.val();
+    StoredSize += buf.size();
+
+    return OK;
+}
+
+static std::mutex KvWriterMutex;
+static std::condition_variable KvWriterCv;
+static std::list<std::shared_ptr<TKeyValueStorage>> KvWriterQueue;
+static std::unique_ptr<std::thread> KvWriterThread;
+static bool KvWriterRunning = false;
+
+TError TKeyValueStorage::Save(std::map<std::string, std::string> &data, bool sync) {
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    Node.Data.swap(data);
+
+    /* Queued flush will write merged data */
+    if (Pending && !sync) {
+        Statistics->KvSavesCoalesced++;
+        return OK;
+    }
+
+    if (!sync && config().keyvalue_write_delay_ms()) {
+        std::unique_lock<std::mutex> writer_lock(KvWriterMutex);
+        if (KvWriterRunning) {
+            Pending = true;
+            QueueTime = GetCurrentTimeMs();
+            KvWriterQueue.push_back(shared_from_this());
+            writer_lock.unlock();
+            KvWriterCv.notify_one();
+            Statistics->KvSavesQueued++;
+            return OK;
+        }
+    }
+
+    Pending = false;
+    return Node.SaveDelta();
+}
+
+TError TKeyValueStorage::Flush() {
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    if (!Pending)
+        return OK;
+
+    Pending = false;
+
+    uint64_t latency = GetCurrentTimeMs() - QueueTime;
+    if (latency > Statistics->KvFlushLatencyMax)
+        Statistics->KvFlushLatencyMax = latency;
+    Statistics->KvFlushes++;
+
+    return Node.SaveDelta();
+}
+
+void TKeyValueStorage::Drop() {
+    std::unique_lock<std::mutex> lock(Mutex);
+    Pending = false;
+}
+
+static void KeyValueWriter() {
+    SetProcessName("portod-KV");
+
+    std::unique_lock<std::mutex> lock(KvWriterMutex);
+
+    while (KvWriterRunning || !KvWriterQueue.empty()) {
+        if (KvWriterQueue.empty()) {
+            KvWriterCv.wait(lock);
+            continue;
+        }
+
+        auto node = KvWriterQueue.front();
+
+        /* queue is ordered by time, flush everything at stop */
+        if (KvWriterRunning) {
+            uint64_t deadline = node->QueueTime + config().keyvalue_write_delay_ms();
+            uint64_t now = GetCurrentTimeMs();
+            if (deadline > now) {
+                KvWriterCv.wait_for(lock, std::chrono::milliseconds(deadline - now));
+                continue;
+            }
+        }
+
+        KvWriterQueue.pop_front();
+        lock.unlock();
+        TError error = node->Flush();
+        if (error)
+            L_ERR("Cannot save key-value node: {}", error);
+        lock.lock();
+    }
+}
+
+void StartKeyValueWriter() {
+    KvWriterRunning = true;
+    KvWriterThread = std::unique_ptr<std::thread>(NewThread(&KeyValueWriter));
+}
+
+void StopKeyValueWriter() {
+    {
+        std::unique_lock<std::mutex> lock(KvWriterMutex);
+        KvWriterRunning = false;
+    }
+    KvWriterCv.notify_all();
+    KvWriterThread->join();
+    KvWriterThread = nullptr;
+}
+
 TError TKeyValue::Mount(const TPath &root) {
     TError error;
     TMount mount;
@@ -3,6 +3,9 @@
 #include <string>
 #include <map>
 #include <list>
+#include <mutex>
+#include <memory>
+#include <atomic>
 #include "common.hpp"
 #include "util/path.hpp"
 
@@ -13,6 +16,11 @@ public:
     std::string Name;
     std::map<std::string, std::string> Data;
 
+    /* Content and size of file after last Save or SaveDelta */
+    std::map<std::string, std::string> Stored;
+    uint64_t StoredSize = 0;
+    uint64_t CompactSize = 0;
+
     TKeyValue(const TPath &path) : Path(path) { }
 
     friend bool operator<(const TKeyValue &lhs, const TKeyValue &rhs) {
@@ -38,8 +46,34 @@ public:
 
     TError Load();
     TError Save();
+    TError SaveDelta();
 
     static TError Mount(const TPath &root);
     static TError ListAll(const TPath &root, std::list<TKeyValue> &nodes);
     static void DumpAll(const TPath &root);
 };
+
+/*
+ * Key-value node with write-behind: saves within keyvalue_write_delay_ms
+ * are coalesced and written by portod-KV thread, sync save writes at once.
+ */
+class TKeyValueStorage : public std::enable_shared_from_this<TKeyValueStorage> {
+    std::mutex Mutex;
+    TKeyValue Node;
+    bool Pending = false;
+
+public:
+    std::atomic<uint64_t> QueueTime{0};
+
+    TKeyValueStorage(const TPath &path) : Node(path) { }
+
+    /* Takes data, node keeps it as current content */
+    TError Save(std::map<std::string, std::string> &data, bool sync);
+    TError Flush();
+
+    /* Forget pending write, call before removing node */
+    void Drop();
+};
+
+void StartKeyValueWriter();
+void StopKeyValueWriter();
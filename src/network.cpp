@@ -628,7 +628,8 @@ void TNetwork::Unregister() {
     NetInode = 0;
 }
 
-TError TNetwork::New(TNamespaceFd &netns, std::shared_ptr<TNetwork> &net, pid_t netnsPid) {
+/* Creates fresh network namespace without moving current thread */
+TError TNetwork::NewNetns(int &fd) {
     TNamespaceFd curNs;
     TError error;
 
@@ -636,6 +637,37 @@ TError TNetwork::New(TNamespaceFd &netns, std::shared_ptr<TNetwork> &net, pid_t
     if (error)
         return error;
 
+    if (unshare(CLONE_NEWNET))
+        return TError::System("unshare(CLONE_NEWNET)");
+
+    fd = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        error = TError::System("open netns");
+
+    TError error2 = curNs.SetNs(CLONE_NEWNET);
+    PORTO_ASSERT(!error2);
+
+    return error;
+}
+
+TError TNetwork::New(TNamespaceFd &netns, std::shared_ptr<TNetwork> &net,
+                     pid_t netnsPid, int netnsFd) {
+    TNamespaceFd curNs;
+    TError error;
+
+    error = curNs.Open("/proc/thread-self/ns/net");
+    if (error) {
+        if (netnsFd >= 0)
+            close(netnsFd);
+        return error;
+    }
+
+    /* Pre-created netns belongs to host userns, useless for netnsPid */
+    if (netnsFd >= 0 && netnsPid) {
+        close(netnsFd);
+        netnsFd = -1;
+    }
+
     if (netnsPid) {
         error = netns.Open(fmt::format("/proc/{}/ns/net", netnsPid));
         if (error)
@@ -644,7 +676,12 @@ TError TNetwork::New(TNamespaceFd &netns, std::shared_ptr<TNetwork> &net, pid_t
         if (error)
             return error;
     } else {
-        if (unshare(CLONE_NEWNET))
+        if (netnsFd >= 0) {
+            int ret = setns(netnsFd, CLONE_NEWNET);
+            close(netnsFd);
+            if (ret)
+                return TError::System("setns(CLONE_NEWNET)");
+        } else if (unshare(CLONE_NEWNET))
             return TError::System("unshare(CLONE_NEWNET)");
 
         error = netns.Open("/proc/thread-self/ns/net");
@@ -3611,7 +3648,10 @@ TError TNetEnv::OpenNetwork(TContainer &ct) {
     }
 
     if (NetIsolate) {
-        error = TNetwork::New(NetNs, Net, ct.UserNs ? ct.Task.Pid : 0);
+        int warmFd = ct.WarmNetns.Fd;
+        ct.WarmNetns.SetFd = -1;
+
+        error = TNetwork::New(NetNs, Net, ct.UserNs ? ct.Task.Pid : 0, warmFd);
         if (error)
             return error;
 
@@ -186,7 +186,9 @@ public:
 
     std::string NetName;
 
-    static TError New(TNamespaceFd &netns, std::shared_ptr<TNetwork> &net, pid_t netnsPid = 0);
+    static TError NewNetns(int &fd);
+    static TError New(TNamespaceFd &netns, std::shared_ptr<TNetwork> &net,
+                      pid_t netnsPid = 0, int netnsFd = -1);
     static TError Open(const TPath &path, TNamespaceFd &netns,
                        std::shared_ptr<TNetwork> &net,
                        bool host = false);
@@ -1400,6 +1400,36 @@ public:
     }
 };
 
+class TStartupCmd final : public ICmd {
+public:
+    TStartupCmd(Porto::Connection *api) : ICmd(api, "startup", 0, "", "print portod startup time breakdown") {}
+
+    int Execute(TCommandEnviroment *) final override {
+        rpc::TContainerRequest req;
+        rpc::TContainerResponse rsp;
+
+        req.mutable_getsystem();
+        int ret = Api->Call(req, rsp);
+        if (ret) {
+            PrintError("Can't get system properties");
+            return ret;
+        }
+
+        for (auto &phase: rsp.getsystem().startup_phase())
+            std::cout << std::left << std::setw(28) << phase.name()
+                      << phase.time_ms() << " ms" << std::endl;
+
+        if (rsp.getsystem().startup_restore_outlier_size()) {
+            std::cout << std::endl << "slowest container restore:" << std::endl;
+            for (auto &ct: rsp.getsystem().startup_restore_outlier())
+                std::cout << "  " << std::left << std::setw(26) << ct.name()
+                          << ct.time_ms() << " ms" << std::endl;
+        }
+
+        return EXIT_SUCCESS;
+    }
+};
+
 class TFindCmd final : public ICmd {
 public:
     TFindCmd(Porto::Connection *api) : ICmd(api, "find", 1, "<pid> [comm]", "find container for given process id") {}
@@ -1436,12 +1466,19 @@ public:
 
 class TDestroyCmd final : public ICmd {
 public:
-    TDestroyCmd(Porto::Connection *api) : ICmd(api, "destroy", 1, "<container1> [container2...]", "destroy container") {}
+    TDestroyCmd(Porto::Connection *api) : ICmd(api, "destroy", 1, "[-A] <container1> [container2...]", "destroy container",
+             "    -A destroy in background, do not wait for cleanup\n") {}
 
     int Execute(TCommandEnviroment *env) final override {
         int exitStatus = EXIT_SUCCESS;
-        for (const auto &arg : env->GetArgs()) {
-            int ret = Api->Destroy(arg);
+        bool async = false;
+
+        const auto &containers = env->GetOpts({
+            { 'A', false, [&](const char *) { async = true; } },
+        });
+
+        for (const auto &arg : containers) {
+            int ret = Api->Destroy(arg, async);
             if (ret) {
                 PrintError("Can't destroy container");
                 exitStatus = ret;
@@ -3198,6 +3235,7 @@ int main(int argc, char *argv[]) {
     handler.RegisterCommand<TShellCmd>();
     handler.RegisterCommand<TEnterCmd>();
     handler.RegisterCommand<TGcCmd>();
+    handler.RegisterCommand<TStartupCmd>();
     handler.RegisterCommand<TFindCmd>();
     handler.RegisterCommand<TWaitCmd>();
 
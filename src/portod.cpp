@@ -16,6 +16,7 @@
 #include "container.hpp"
 #include "volume.hpp"
 #include "storage.hpp"
+#include "warmpool.hpp"
 #include "helpers.hpp"
 #include "core.hpp"
 #include "util/log.hpp"
@@ -24,6 +25,7 @@
 #include "util/string.hpp"
 #include "util/cred.hpp"
 #include "util/worker.hpp"
+#include "util/thread.hpp"
 #include "property.hpp"
 #include "portod.hpp"
 #include "libporto.hpp"
@@ -75,6 +77,18 @@ static uint64_t ShutdownStart = 0;
 static uint64_t ShutdownDeadline = 0;
 std::atomic_bool NeedStopHelpers(false);
 
+std::mutex StartupProfileMutex;
+std::vector<TStartupPhase> StartupPhases;
+std::vector<TStartupPhase> StartupRestoreOutliers;
+static bool FirstAccept = true;
+
+constexpr size_t STARTUP_RESTORE_OUTLIERS = 10;
+
+static void AddStartupPhase(const std::string &name, uint64_t start) {
+    std::lock_guard<std::mutex> guard(StartupProfileMutex);
+    StartupPhases.push_back({name, GetCurrentTimeMs() - start});
+}
+
 bool SupportCgroupNs = false;
 bool EnableOsModeCgroupNs = false;
 bool EnableRwCgroupFs = false;
@@ -311,6 +325,13 @@ static TError AcceptConnection(int listenFd) {
 
     Statistics->ClientsConnected++;
 
+    if (FirstAccept) {
+        FirstAccept = false;
+        AddStartupPhase("post_restore_first_accept", Statistics->PortoStarted);
+        L_SYS("First connection accepted in {} ms after start",
+              GetCurrentTimeMs() - Statistics->PortoStarted);
+    }
+
     auto client = std::make_shared<TClient>(clientFd);
     error = client->IdentifyClient();
     if (error)
@@ -368,6 +389,34 @@ static void StartShutdown() {
     }
 }
 
+static std::unique_ptr<std::thread> LazyRestoreThread;
+
+/* Loads lazily restored containers in background, parents first */
+static void LazyRestoreLoop() {
+    uint64_t start = GetCurrentTimeMs();
+    uint64_t count = 0;
+
+    SetProcessName("portod-LR");
+
+    TClient client("<restore>");
+    client.ClientContainer = RootContainer;
+    client.StartRequest();
+
+    auto subtree = RootContainer->Subtree();
+    subtree.reverse();
+
+    for (auto &ct: subtree) {
+        if (ShutdownPortod || NeedStopHelpers)
+            break;
+        if (ct->Lazy && !ct->LoadLazy())
+            count++;
+    }
+
+    client.FinishRequest();
+
+    L_SYS("Restore {} lazy containers in {} ms", count, GetCurrentTimeMs() - start);
+}
+
 static void PortodServer() {
     TError error;
 
@@ -396,8 +445,13 @@ static void PortodServer() {
     }
 
     StartStatFsLoop();
+    StartKeyValueWriter();
+    if (Statistics->ContainersLazy)
+        LazyRestoreThread = std::unique_ptr<std::thread>(NewThread(&LazyRestoreLoop));
     StartRpcQueue();
     EventQueue->Start();
+    TContainer::StartDestroyReaper();
+    TWarmPool::Start();
 
     if (config().daemon().log_rotate_ms()) {
         TEvent ev(EEventType::RotateLogs);
@@ -473,6 +527,19 @@ static void PortodServer() {
                 // from the clients (so clients see updated view of the
                 // world as soon as possible)
                 continue;
+            } else if (source->Flags & EPOLL_EVENT_EXIT) {
+                auto container = source->Container.lock();
+
+                /* Pidfd stays readable until zombie is reaped */
+                EpollLoop->StopInput(source->Fd);
+
+                if (container) {
+                    TEvent e(EEventType::Exit, container);
+                    e.Exit.Pid = container->WaitTask.Pid;
+                    e.Exit.Pidfd = true;
+                    EventQueue->Add(0, e);
+                }
+
             } else if (source->Flags & EPOLL_EVENT_OOM) {
                 auto container = source->Container.lock();
 
@@ -520,9 +587,18 @@ exit:
 
     L_SYS("Stop threads...");
     EventQueue->Stop();
+    TContainer::StopDestroyReaper();
+    TWarmPool::Stop();
     StopRpcQueue();
+    if (LazyRestoreThread) {
+        LazyRestoreThread->join();
+        LazyRestoreThread = nullptr;
+    }
+    StopKeyValueWriter();
     StopStatFsLoop();
+    TCgroupPool::Stop();
     TStorage::StopAsyncRemover();
+    StopHelpersZygote();
 }
 
 static TError TuneLimits() {
@@ -620,16 +696,58 @@ static TError CreateRootContainer() {
     return OK;
 }
 
+/* Run action for items in parallel, workers act as internal clients */
+static void RestoreParallel(size_t count, const std::function<void(size_t)> &action) {
+    std::atomic<size_t> next(0);
+    unsigned threads = std::max(config().daemon().restore_threads(), 1u);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++)
+            action(i);
+    };
+
+    auto threadWorker = [&]() {
+        TClient client("<restore>");
+        client.ClientContainer = RootContainer;
+        client.StartRequest();
+        worker();
+        client.FinishRequest();
+    };
+
+    std::vector<std::unique_ptr<std::thread>> workers;
+    for (unsigned i = 1; i < std::min<size_t>(threads, count); i++)
+        workers.emplace_back(NewThread([&threadWorker]() { threadWorker(); }));
+
+    worker();
+
+    for (auto &thread: workers)
+        thread->join();
+}
+
 static void RestoreContainers() {
     TIdMap ids(4, CONTAINER_ID_MAX - 4);
     std::list<TKeyValue> nodes;
+    std::atomic<uint64_t> lost(0);
+    uint64_t start = GetCurrentTimeMs();
 
     TError error = TKeyValue::ListAll(ContainersKV, nodes);
     if (error)
         FatalError("Cannot list container kv", error);
 
-    for (auto node = nodes.begin(); node != nodes.end(); ) {
-        error = node->Load();
+    std::vector<TKeyValue *> items;
+    std::vector<TError> errors(nodes.size());
+    for (auto &node: nodes)
+        items.push_back(&node);
+
+    RestoreParallel(items.size(), [&](size_t i) {
+        errors[i] = items[i]->Load();
+    });
+
+    uint64_t parsed = GetCurrentTimeMs();
+
+    size_t index = 0;
+    for (auto node = nodes.begin(); node != nodes.end(); index++) {
+        error = errors[index];
         if (!error) {
             if (!node->Has(P_RAW_ID))
                 error = TError("id not found");
@@ -666,19 +784,73 @@ static void RestoreContainers() {
 
     nodes.sort();
 
+    /*
+     * Containers of each depth level are restored in parallel, level by
+     * level: parent must be restored before its children.
+     */
+    std::vector<std::vector<TKeyValue *>> levels;
     for (auto &node : nodes) {
         if (node.Name[0] == '/')
             continue;
+        size_t level = std::count(node.Name.begin(), node.Name.end(), '/');
+        if (levels.size() <= level)
+            levels.resize(level + 1);
+        levels[level].push_back(&node);
+    }
 
-        std::shared_ptr<TContainer> ct;
-        error = TContainer::Restore(node, ct);
-        if (error) {
-            L_ERR("Cannot restore {}: {}", node.Name, error);
-            Statistics->ContainerLost++;
-            node.Path.Unlink();
-            continue;
+    /*
+     * Stopped and dead containers without running descendants are restored
+     * from header and loaded at first access or by background thread.
+     */
+    std::unordered_set<std::string> live;
+    if (config().daemon().lazy_restore()) {
+        for (auto &node : nodes) {
+            auto state = node.Get(P_STATE);
+            if ((state == "stopped" || state == "dead") && node.Get(P_RESPAWN) != "true")
+                continue;
+            for (auto name = node.Name; name != ROOT_CONTAINER;
+                    name = TContainer::ParentName(name))
+                live.insert(name);
         }
     }
+
+    std::mutex timesMutex;
+    std::vector<TStartupPhase> times;
+
+    for (auto &level: levels) {
+        RestoreParallel(level.size(), [&](size_t i) {
+            auto node = level[i];
+            std::shared_ptr<TContainer> ct;
+            uint64_t ctStart = GetCurrentTimeMs();
+            bool lazy = config().daemon().lazy_restore() && !live.count(node->Name);
+            TError error = TContainer::Restore(*node, ct, lazy);
+            std::unique_lock<std::mutex> lock(timesMutex);
+            times.push_back({node->Name, GetCurrentTimeMs() - ctStart});
+            lock.unlock();
+            if (error) {
+                L_ERR("Cannot restore {}: {}", node->Name, error);
+                Statistics->ContainerLost++;
+                lost++;
+                node->Path.Unlink();
+            }
+        });
+    }
+
+    uint64_t restored = GetCurrentTimeMs();
+
+    auto outliers = std::min(times.size(), STARTUP_RESTORE_OUTLIERS);
+    std::partial_sort(times.begin(), times.begin() + outliers, times.end(),
+                      [](const TStartupPhase &a, const TStartupPhase &b) {
+                          return a.TimeMs > b.TimeMs;
+                      });
+    times.resize(outliers);
+
+    std::unique_lock<std::mutex> lock(StartupProfileMutex);
+    StartupRestoreOutliers = times;
+    lock.unlock();
+
+    L_SYS("Restore {} containers in {} levels: load {} ms, restore {} ms, lost {}",
+          nodes.size(), levels.size(), parsed - start, restored - parsed, lost.load());
 }
 
 static void CleanupCgroups() {
@@ -786,6 +958,20 @@ static void DestroyContainers(bool weak) {
     TVolume::DestroyUnlinked(unlinked);
 }
 
+static void LogStartupProfile() {
+    std::string phases, outliers;
+
+    std::lock_guard<std::mutex> guard(StartupProfileMutex);
+    for (auto &phase: StartupPhases)
+        phases += fmt::format(" {}={}", phase.Name, phase.TimeMs);
+    for (auto &phase: StartupRestoreOutliers)
+        outliers += fmt::format(" {}={}", phase.Name, phase.TimeMs);
+
+    L_SYS("Startup profile ms:{}", phases);
+    if (!outliers.empty())
+        L_SYS("Slowest container restore ms:{}", outliers);
+}
+
 static int Portod() {
     TError error;
 
@@ -837,7 +1023,10 @@ static int Portod() {
     InitCapabilities();
     InitIpcSysctl();
     InitProcBaseDirs();
+
+    uint64_t phaseStart = GetCurrentTimeMs();
     TNetwork::InitializeConfig();
+    AddStartupPhase("network_init", phaseStart);
 
     L_SYS("Portod config:\n{}", config().DebugString());
 
@@ -870,6 +1059,7 @@ static int Portod() {
     if (error)
         FatalError("Can't adjust OOM score", error);
 
+    phaseStart = GetCurrentTimeMs();
     error = InitializeCgroups();
     if (error)
         FatalError("Cannot initalize cgroups", error);
@@ -880,7 +1070,16 @@ static int Portod() {
 
     InitContainerProperties();
     TStorage::Init();
+    AddStartupPhase("cgroups_init", phaseStart);
 
+    /* Fork before restore inflates portod */
+    phaseStart = GetCurrentTimeMs();
+    error = StartHelpersZygote();
+    if (error)
+        L_WRN("Cannot start helpers zygote: {}", error);
+    AddStartupPhase("helpers_zygote", phaseStart);
+
+    phaseStart = GetCurrentTimeMs();
     ContainersKV = TPath(PORTO_CONTAINERS_KV);
     error = TKeyValue::Mount(ContainersKV);
     if (error)
@@ -890,6 +1089,7 @@ static int Portod() {
     error = TKeyValue::Mount(VolumesKV);
     if (error)
         FatalError("Cannot mount volumes keyvalue", error);
+    AddStartupPhase("kv_mount", phaseStart);
 
     TPath root("/");
     error = root.Chdir();
@@ -932,15 +1132,21 @@ static int Portod() {
     SystemClient.ClientContainer = RootContainer;
 
     L_SYS("Restore containers...");
+    phaseStart = GetCurrentTimeMs();
     TCgroup::StartRestore();
     RestoreContainers();
     TCgroup::FinishRestore();
+    AddStartupPhase("restore_containers", phaseStart);
 
     L_SYS("Restore statistics...");
+    phaseStart = GetCurrentTimeMs();
     TContainer::SyncPropertiesAll();
+    AddStartupPhase("restore_statistics", phaseStart);
 
     L_SYS("Restore volumes...");
+    phaseStart = GetCurrentTimeMs();
     TVolume::RestoreAll();
+    AddStartupPhase("restore_volumes", phaseStart);
 
     DestroyContainers(true);
 
@@ -957,12 +1163,22 @@ static int Portod() {
     SystemClient.FinishRequest();
 
     L_SYS("Cleanup cgroup...");
+    phaseStart = GetCurrentTimeMs();
     CleanupCgroups();
+    AddStartupPhase("cleanup_cgroups", phaseStart);
+
+    /* After cleanup: leftovers of previous instance are removed there */
+    TCgroupPool::Start();
 
     L_SYS("Cleanup workdir...");
+    phaseStart = GetCurrentTimeMs();
     CleanupWorkdir();
+    AddStartupPhase("cleanup_workdir", phaseStart);
+
+    AddStartupPhase("total", Statistics->PortoStarted);
 
     L_SYS("Restore complete. time={} ms", GetCurrentTimeMs() - Statistics->PortoStarted);
+    LogStartupProfile();
 
     PortodServer();
 
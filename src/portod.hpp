@@ -1,5 +1,10 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+
 class TEpollLoop;
 class TEventQueue;
 
@@ -12,3 +17,13 @@ extern bool ShutdownPortod;
 
 void ReopenMasterLog();
 void CheckPortoSocket();
+
+struct TStartupPhase {
+    std::string Name;
+    uint64_t TimeMs;
+};
+
+/* Restore phases end with "total", post_restore_* are added later by server loop */
+extern std::mutex StartupProfileMutex;
+extern std::vector<TStartupPhase> StartupPhases;
+extern std::vector<TStartupPhase> StartupRestoreOutliers;
@@ -11,10 +11,66 @@
 #include <sys/ptrace.h>
 
 #include "version.hpp"
+#include "ringlog.hpp"
 
 static pid_t target = -1;
 int seize = 0;
 
+static int ring_header(int fd, const struct porto_ring_header *hdr) {
+    return pwrite(fd, hdr, sizeof(*hdr), 0) == sizeof(*hdr) ? 0 : -1;
+}
+
+/* Copy stdin into circular log at stdout until eof */
+static int ring_loop(void) {
+    struct porto_ring_header hdr;
+    static char buf[65536];
+    ssize_t len;
+
+    if (pread(1, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+            hdr.magic != PORTO_RING_MAGIC || !hdr.size)
+        return EXIT_FAILURE;
+
+    while (1) {
+        char *ptr = buf;
+
+        len = read(0, buf, sizeof(buf));
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            return len ? EXIT_FAILURE : EXIT_SUCCESS;
+
+        /* Only last size bytes will survive */
+        if ((uint64_t)len > hdr.size) {
+            hdr.tail += len - hdr.size;
+            ptr += len - hdr.size;
+            len = hdr.size;
+        }
+
+        /* Readers must not see data which is going to be overwritten */
+        if (hdr.tail + len - hdr.head > hdr.size) {
+            hdr.head = hdr.tail + len - hdr.size;
+            if (ring_header(1, &hdr))
+                return EXIT_FAILURE;
+        }
+
+        while (len) {
+            uint64_t pos = hdr.tail % hdr.size;
+            size_t chunk = hdr.size - pos;
+
+            if (chunk > (size_t)len)
+                chunk = len;
+            if (pwrite(1, ptr, chunk, PORTO_RING_DATA + pos) != (ssize_t)chunk)
+                return EXIT_FAILURE;
+            hdr.tail += chunk;
+            ptr += chunk;
+            len -= chunk;
+        }
+
+        if (ring_header(1, &hdr))
+            return EXIT_FAILURE;
+    }
+}
+
 static void forward(int sig) {
     kill(target, sig);
     signal(sig, SIG_DFL);
@@ -29,6 +85,11 @@ int main(int argc, char *argv[]) {
             return EXIT_SUCCESS;
         }
 
+        if (!strcmp(argv[argn], "--ring")) {
+            prctl(PR_SET_NAME, "portoinit-ring");
+            return ring_loop();
+        }
+
         if (!strcmp(argv[argn], "--seize"))
             seize = 1;
         else if (strcmp(argv[argn], "--wait"))
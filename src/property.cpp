@@ -7,6 +7,7 @@
 #include "container.hpp"
 #include "volume.hpp"
 #include "network.hpp"
+#include "warmpool.hpp"
 #include "util/log.hpp"
 #include "util/string.hpp"
 #include "util/unix.hpp"
@@ -1797,6 +1798,56 @@ public:
     }
 } static Root;
 
+class TWarmTemplateProperty : public TProperty {
+public:
+    TWarmTemplateProperty() : TProperty(P_WARM_TEMPLATE, EProperty::WARM_TEMPLATE,
+            "Take root volume and netns from warm pool template at start") {}
+    TError Get(std::string &value) const override {
+        value = CT->WarmTemplate;
+        return OK;
+    }
+    TError Set(const std::string &value) override {
+        if (value.size() && !TWarmPool::HasTemplate(value))
+            return TError(EError::InvalidValue, "Unknown warm template {}", value);
+        return Load(value);
+    }
+
+    /* Template could be removed from config, start reports it */
+    TError Load(const std::string &value) override {
+        CT->WarmTemplate = value;
+        CT->SetProp(EProperty::WARM_TEMPLATE);
+        return OK;
+    }
+
+    void Dump(rpc::TContainerSpec &spec) const override {
+        spec.set_warm_template(CT->WarmTemplate);
+    }
+
+    bool Has(const rpc::TContainerSpec &spec) const override {
+        return spec.has_warm_template();
+    }
+
+    TError Load(const rpc::TContainerSpec &spec) override {
+        return Set(spec.warm_template());
+    }
+} static WarmTemplate;
+
+class TRawWarmRoot : public TProperty {
+public:
+    TRawWarmRoot() : TProperty(P_RAW_WARM_ROOT, EProperty::WARM_ROOT, "") {
+        IsReadOnly = true;
+        IsHidden = true;
+    }
+    TError Get(std::string &value) const override {
+        value = CT->WarmRoot.ToString();
+        return OK;
+    }
+    TError Set(const std::string &value) override {
+        CT->SetWarmRoot(value);
+        return OK;
+    }
+} static RawWarmRoot;
+
 class TRootPath : public TProperty {
 public:
     TRootPath() : TProperty(P_ROOT_PATH, EProperty::NONE, "Container root path in client namespace") {
@@ -2803,6 +2854,28 @@ public:
     }
 } static SeizePid;
 
+class TRawDestroyQueued : public TProperty {
+public:
+    TRawDestroyQueued() : TProperty(P_RAW_DESTROY_QUEUED, EProperty::DESTROY_QUEUED, "") {
+        IsReadOnly = true;
+        IsHidden = true;
+    }
+    TError Get(std::string &value) const override {
+        auto lock = LockContainers();
+        value = BoolToString(CT->DestroyQueued);
+        return OK;
+    }
+    TError Set(const std::string &value) override {
+        bool val;
+        TError error = StringToBool(value, val);
+        if (error)
+            return error;
+        auto lock = LockContainers();
+        CT->DestroyQueued = val;
+        return OK;
+    }
+} static RawDestroyQueued;
+
 class TRawCreationTime : public TProperty {
 public:
     TRawCreationTime() : TProperty(P_RAW_CREATION_TIME, EProperty::CREATION_TIME, "") {
@@ -4462,6 +4535,8 @@ public:
     TError Set(uint64_t new_time) {
         CT->AgingTime = new_time * 1000;
         CT->SetProp(EProperty::AGING_TIME);
+        if (CT->State == EContainerState::Dead)
+            CT->ScheduleAging();
         return OK;
     }
 
@@ -6343,6 +6418,38 @@ public:
     }
 } static StartTime;
 
+class TStartTimings : public TProperty {
+public:
+    TStartTimings() : TProperty(P_START_TIMINGS, EProperty::NONE,
+            "Duration of last start phases: <phase>: <us>; ...") {
+        IsReadOnly = true;
+        IsRuntimeOnly = true;
+    }
+    TError Get(std::string &value) const override {
+        for (auto &it: CT->GetStartTimings())
+            value += fmt::format("{}{}: {}", value.empty() ? "" : "; ", it.first, it.second);
+        return OK;
+    }
+    TError GetIndexed(const std::string &index, std::string &value) override {
+        for (auto &it: CT->GetStartTimings()) {
+            if (it.first == index) {
+                value = std::to_string(it.second);
+                return OK;
+            }
+        }
+        return TError(EError::InvalidProperty, "Unknown start phase {}", index);
+    }
+
+    void Dump(rpc::TContainerStatus &spec) const override {
+        auto map = spec.mutable_start_timings();
+        for (auto &it: CT->GetStartTimings()) {
+            auto kv = map->add_map();
+            kv->set_key(it.first);
+            kv->set_val(it.second);
+        }
+    }
+} static StartTimings;
+
 class TDeathTime : public TProperty {
 public:
     TDeathTime() : TProperty(P_DEATH_TIME, EProperty::NONE, "Death time") {
@@ -6403,9 +6510,9 @@ public:
 void TPortoStat::Populate(TUintMap &m) const {
     for (const auto &it : PortoStatMembers) {
         if (it.second.TimeStat)
-            m[it.first] = (GetCurrentTimeMs() - Statistics->*(it.second.Member)) / 1000;
+            m[it.first] = (GetCurrentTimeMs() - it.second.Get()) / 1000;
         else
-            m[it.first] = Statistics->*(it.second.Member);
+            m[it.first] = it.second.Get();
     }
 
     uint64_t usage = 0;
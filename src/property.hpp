@@ -11,6 +11,8 @@ constexpr const char *P_RAW_NAME = "_name";
 constexpr const char *P_RAW_CREATION_TIME = "_creation_time";
 constexpr const char *P_RAW_START_TIME = "_start_time";
 constexpr const char *P_RAW_DEATH_TIME = "_death_time";
+constexpr const char *P_RAW_WARM_ROOT = "_warm_root";
+constexpr const char *P_RAW_DESTROY_QUEUED = "_destroy_queued";
 
 constexpr const char *P_TAINT = "taint";
 
@@ -30,6 +32,7 @@ constexpr const char *P_PORTO_NAMESPACE = "porto_namespace";
 constexpr const char *P_PLACE = "place";
 constexpr const char *P_PLACE_LIMIT = "place_limit";
 constexpr const char *P_ROOT = "root";
+constexpr const char *P_WARM_TEMPLATE = "warm_template";
 constexpr const char *P_ROOT_PATH = "root_path";
 constexpr const char *P_ROOT_RDONLY = "root_readonly";
 constexpr const char *P_CWD = "cwd";
@@ -172,6 +175,7 @@ constexpr const char *P_IO_TIME = "io_time";
 constexpr const char *P_TIME = "time";
 constexpr const char *P_CREATION_TIME = "creation_time";
 constexpr const char *P_START_TIME = "start_time";
+constexpr const char *P_START_TIMINGS = "start_timings";
 constexpr const char *P_DEATH_TIME = "death_time";
 constexpr const char *P_CHANGE_TIME = "change_time";
 constexpr const char *P_PORTO_STAT = "porto_stat";
@@ -277,6 +281,9 @@ enum class EProperty {
     NET_RX_LIMIT,
     CORE_COMMAND,
     REQUIRED_VOLUMES,
+    WARM_TEMPLATE,
+    WARM_ROOT,
+    DESTROY_QUEUED,
     NR_PROPERTIES,
 };
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Circular log for stdout/stderr: header followed by fixed size data area.
+ *
+ * Byte at logical offset X is stored at PORTO_RING_DATA + X % size,
+ * bytes in range [head, tail) are available. Writer is portoinit --ring,
+ * it moves head before overwriting data and moves tail after writing.
+ */
+
+#define PORTO_RING_MAGIC    0x31474e49524f5450ull  /* "PTORING1" */
+#define PORTO_RING_DATA     4096
+
+struct porto_ring_header {
+    uint64_t magic;
+    uint64_t size;
+    uint64_t head;
+    uint64_t tail;
+};
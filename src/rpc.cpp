@@ -18,6 +18,7 @@
 #include "storage.hpp"
 #include "docker.hpp"
 #include "util/quota.hpp"
+#include "util/hgram.hpp"
 
 #include <google/protobuf/descriptor.h>
 
@@ -144,6 +145,10 @@ void TRequest::Parse() {
     } else if (Req.has_start()) {
         Cmd = "Start";
         Arg = Req.start().name();
+    } else if (Req.has_startcontainers()) {
+        Cmd = "StartContainers";
+        for (auto &name: Req.startcontainers().name())
+            opts.push_back(name);
     } else if (Req.has_stop()) {
         Cmd = "Stop";
         Arg = Req.stop().name();
@@ -422,6 +427,9 @@ static std::string ResponseAsString(const rpc::TContainerResponse &resp) {
             ret = "AsyncWait timeout";
         else
             ret = "AsyncWait " + resp.asyncwait().name() + " state=" + resp.asyncwait().state();
+    } else if (resp.has_asyncwaitbatch()) {
+        ret = fmt::format("AsyncWaitBatch events={} dropped={}",
+                          resp.asyncwaitbatch().event_size(), resp.asyncwaitbatch().dropped());
     } else if (resp.has_convertpath())
         ret = resp.convertpath().path();
     else
@@ -509,7 +517,9 @@ undo:
     return error;
 }
 
-noinline TError UpdateFromSpec(const rpc::TUpdateFromSpecRequest &req) {
+noinline TError UpdateFromSpec(const rpc::TUpdateFromSpecRequest &req,
+                               rpc::TUpdateFromSpecResponse &rsp) {
+    std::vector<std::string> changed;
     std::shared_ptr<TContainer> ct;
     TError error;
 
@@ -517,9 +527,16 @@ noinline TError UpdateFromSpec(const rpc::TUpdateFromSpecRequest &req) {
     if (error)
         return error;
 
-    error = ct->Load(req.container(), true);
+    error = ct->Load(req.container(), true, &changed);
     CL->ReleaseContainer();
 
+    if (!error) {
+        for (auto &field: changed)
+            rsp.add_changed(field);
+        if (changed.empty())
+            Statistics->SpecUpdatesUnchanged++;
+    }
+
     return error;
 }
 
@@ -544,16 +561,21 @@ noinline TError ListContainersBy(const rpc::TListContainersRequest &req,
     for(auto &prop: req.field_options().properties())
         props.push_back(prop);
 
+    std::vector<TResolvedProperty> resolved;
+    TContainer::ResolveDumpProperties(props, propsOps, resolved);
+
     auto lock = LockContainers();
     for (auto &it: Containers) {
         auto &ct = it.second;
         std::string name;
-        if (CL->ComposeName(ct->Name, name))
+        if (CL->ComposeName(ct->Name, name) || ct->IsDestroyQueued())
             continue;
         names.push_back(name);
     }
     lock.unlock();
 
+    std::sort(names.begin(), names.end());
+
     std::set<std::string> found;
 
     for (const auto &name : names) {
@@ -561,6 +583,8 @@ noinline TError ListContainersBy(const rpc::TListContainersRequest &req,
         lock.lock();
         auto error = CL->ResolveContainer(name, ct);
         lock.unlock();
+        if (!error)
+            error = ct->LoadLazy();
         if (error)
             continue;
         for (auto filter : req.filters()) {
@@ -574,7 +598,7 @@ noinline TError ListContainersBy(const rpc::TListContainersRequest &req,
 
                 error = CL->LockContainer(ct);
                 if (!error) {
-                    ct->Dump(props, propsOps, *container);
+                    ct->Dump(resolved, *container);
                     CL->ReleaseContainer();
                 } else
                     error.Dump(*container->mutable_error());
@@ -627,6 +651,12 @@ noinline TError DestroyContainer(const rpc::TContainerDestroyRequest &req) {
     if (error)
         return error;
 
+    if (req.async()) {
+        error = ct->DestroyAsync();
+        CL->ReleaseContainer();
+        return error;
+    }
+
     error = ct->Destroy(unlinked);
 
     CL->ReleaseContainer();
@@ -644,6 +674,105 @@ static noinline TError StartContainer(const rpc::TContainerStartRequest &req) {
     return ct->Start();
 }
 
+/*
+ * Containers are validated and their parents are started first, then
+ * requested containers are started by workers with clients acting as
+ * caller, so siblings are locked and started independently. Container
+ * waits for its nearest requested ancestor, parents between them are
+ * started by its own start.
+ */
+static noinline TError StartContainers(const rpc::TStartContainersRequest &req,
+                                       rpc::TStartContainersResponse &rsp) {
+    std::list<std::shared_ptr<TContainer>> cts;
+    std::unordered_map<TContainer *, int> index;
+    std::vector<TError> results(req.name_size());
+    TError error;
+
+    for (int i = 0; i < req.name_size(); i++) {
+        std::shared_ptr<TContainer> ct;
+
+        error = CL->WriteContainer(req.name(i), ct);
+        if (!error && index.count(ct.get()))
+            error = TError(EError::InvalidValue, "Container {} is listed twice", ct->Name);
+        if (!error && ct->State != EContainerState::Stopped)
+            error = TError(EError::InvalidState, "Cannot start container {} in state {}",
+                           ct->Name, TContainer::StateName(ct->State));
+        CL->ReleaseContainer();
+
+        results[i] = error;
+        if (!error) {
+            index[ct.get()] = i;
+            cts.push_back(ct);
+        }
+    }
+
+    /* Parents out of request are started once, before siblings */
+    for (auto it = cts.begin(); it != cts.end(); ) {
+        auto ct = *it;
+        bool requested = false;
+
+        for (auto p = ct->Parent.get(); p && !requested; p = p->Parent.get())
+            requested = index.count(p);
+
+        if (requested || ct->Parent->IsRoot()) {
+            ++it;
+            continue;
+        }
+
+        /* Locked container holds parents, StartParents checks their state */
+        error = CL->LockContainer(ct);
+        if (!error)
+            error = ct->StartParents();
+        CL->ReleaseContainer();
+
+        if (error) {
+            results[index[ct.get()]] = error;
+            index.erase(ct.get());
+            it = cts.erase(it);
+        } else
+            ++it;
+    }
+
+    std::mutex mutex;
+    uint64_t start = GetCurrentTimeMs();
+
+    /* Each worker has own client, locks are taken per container */
+    (void)TContainer::ForEachParallel(cts, ESubtreeOrder::ParentsFirst,
+                                      config().daemon().start_threads(),
+                                      [&](std::shared_ptr<TContainer> &ct) -> TError {
+        std::shared_ptr<TContainer> target;
+        int i;
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            i = index[ct.get()];
+        }
+
+        TError error = CL->WriteContainer(req.name(i), target);
+        if (!error)
+            error = target->Start();
+        CL->ReleaseContainer();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        results[i] = error;
+
+        /* Result is per container, keep starting others */
+        return OK;
+    });
+
+    L_ACT("Started {} containers in {} ms", cts.size(), GetCurrentTimeMs() - start);
+
+    for (int i = 0; i < req.name_size(); i++) {
+        auto result = rsp.add_result();
+        result->set_name(req.name(i));
+        result->set_error(results[i].Error);
+        if (results[i])
+            result->set_errormsg(results[i].Message());
+    }
+
+    return OK;
+}
+
 noinline TError StopContainer(const rpc::TContainerStopRequest &req) {
     std::shared_ptr<TContainer> ct;
     TError error = CL->WriteContainer(req.name(), ct);
@@ -682,17 +811,23 @@ noinline TError RespawnContainer(const rpc::TContainerRespawnRequest &req) {
 noinline TError ListContainers(const rpc::TContainerListRequest &req,
                                rpc::TContainerResponse &rsp) {
     std::string mask = req.has_mask() ? req.mask() : "***";
+    std::vector<std::string> names;
     auto lock = LockContainers();
     for (auto &it: Containers) {
         auto &ct = it.second;
         std::string name;
         if (ct->IsRoot() || CL->ComposeName(ct->Name, name) ||
-                !StringMatch(name, mask))
+                !StringMatch(name, mask) || ct->IsDestroyQueued())
             continue;
         if (req.has_changed_since() && ct->ChangeTime < req.changed_since())
             continue;
-        rsp.mutable_list()->add_name(name);
+        names.push_back(name);
     }
+    lock.unlock();
+
+    std::sort(names.begin(), names.end());
+    for (auto &name: names)
+        rsp.mutable_list()->add_name(name);
     return OK;
 }
 
@@ -701,14 +836,21 @@ noinline TError FindLabel(const rpc::TFindLabelRequest &req, rpc::TFindLabelResp
     bool wild_label = label.find_first_of("*?") != std::string::npos;
 
     auto lock = LockContainers();
+    std::vector<std::shared_ptr<TContainer>> cts;
     for (auto &it: Containers) {
-        auto &ct = it.second;
+        if (StringStartsWith(it.first, CL->PortoNamespace) && !it.second->IsDestroyQueued())
+            cts.push_back(it.second);
+    }
+
+    std::sort(cts.begin(), cts.end(),
+              [](const std::shared_ptr<TContainer> &a, const std::shared_ptr<TContainer> &b) {
+                  return a->Name < b->Name;
+              });
+
+    for (auto &ct: cts) {
         std::string value;
         std::string name;
 
-        if (!StringStartsWith(ct->Name, CL->PortoNamespace))
-            continue;
-
         if (req.has_state() && TContainer::StateName(ct->State) != req.state())
             continue;
 
@@ -894,6 +1036,7 @@ out:
 }
 
 static void FillGetResponse(const rpc::TContainerGetRequest &req,
+                            const std::vector<TResolvedProperty> &vars,
                             rpc::TContainerGetResponse &rsp,
                             std::string &name) {
     std::shared_ptr<TContainer> ct;
@@ -901,6 +1044,8 @@ static void FillGetResponse(const rpc::TContainerGetRequest &req,
     auto lock = LockContainers();
     TError containerError = CL->ResolveContainer(name, ct);
     lock.unlock();
+    if (!containerError)
+        containerError = ct->LoadLazy();
 
     auto entry = rsp.add_list();
     entry->set_name(name);
@@ -916,9 +1061,7 @@ static void FillGetResponse(const rpc::TContainerGetRequest &req,
         }
     }
 
-    for (int j = 0; j < req.variable_size(); j++) {
-        auto var = req.variable(j);
-
+    for (auto &var: vars) {
         auto keyval = entry->add_keyval();
         std::string value;
 
@@ -928,7 +1071,7 @@ static void FillGetResponse(const rpc::TContainerGetRequest &req,
         if (!error)
             error = ct->GetProperty(var, value);
 
-        keyval->set_variable(var);
+        keyval->set_variable(var.Name);
         if (error) {
             keyval->set_error(error.Error);
             keyval->set_errormsg(error.Message());
@@ -956,28 +1099,35 @@ noinline TError GetContainerCombined(const rpc::TContainerGetRequest &req,
     }
 
     if (!masks.empty()) {
+        std::vector<std::string> found;
         auto lock = LockContainers();
         for (auto &it: Containers) {
             auto &ct = it.second;
             std::string name;
-            if (ct->IsRoot() || CL->ComposeName(ct->Name, name))
+            if (ct->IsRoot() || CL->ComposeName(ct->Name, name) || ct->IsDestroyQueued())
                 continue;
-            if (masks.empty())
-                names.push_back(name);
             for (auto &mask: masks) {
                 if (StringMatch(name, mask)) {
-                    names.push_back(name);
+                    found.push_back(name);
                     break;
                 }
             }
         }
+        lock.unlock();
+
+        std::sort(found.begin(), found.end());
+        names.insert(names.end(), found.begin(), found.end());
     }
 
     if (req.has_sync() && req.sync())
         TContainer::SyncPropertiesAll();
 
+    std::vector<TResolvedProperty> vars(req.variable_size());
+    for (int i = 0; i < req.variable_size(); i++)
+        TContainer::ResolveProperty(req.variable(i), vars[i]);
+
     for (auto &name: names)
-        FillGetResponse(req, *get, name);
+        FillGetResponse(req, vars, *get, name);
 
     return OK;
 }
@@ -1045,6 +1195,11 @@ noinline TError WaitContainers(const rpc::TContainerWaitRequest &req, bool async
     if (req.has_target_state())
         waiter->TargetState = req.target_state();
 
+    if (async && !stop) {
+        auto clientLock = client->Lock();
+        client->BatchReports = req.batch();
+    }
+
     for (auto &label: req.label())
         waiter->Labels.push_back(label);
 
@@ -1105,9 +1260,19 @@ noinline TError WaitContainers(const rpc::TContainerWaitRequest &req, bool async
         return TContainerWaiter::Remove(*waiter, *client);
 
     if (!waiter->Wildcards.empty()) {
+        std::vector<std::shared_ptr<TContainer>> cts;
         for (auto &it: Containers) {
-            auto &ct = it.second;
-            if (!waiter->ShouldReport(*ct) || client->ComposeName(ct->Name, name))
+            if (waiter->ShouldReport(*it.second))
+                cts.push_back(it.second);
+        }
+
+        std::sort(cts.begin(), cts.end(),
+                  [](const std::shared_ptr<TContainer> &a, const std::shared_ptr<TContainer> &b) {
+                      return a->Name < b->Name;
+                  });
+
+        for (auto &ct: cts) {
+            if (client->ComposeName(ct->Name, name))
                 continue;
 
             if (waiter->Labels.empty()) {
@@ -1976,6 +2141,9 @@ noinline static TError GetSystemProperties(const rpc::TGetSystemRequest *, rpc::
     rsp->set_container_lost(Statistics->ContainerLost);
     rsp->set_container_tainted(Statistics->ContainersTainted);
     rsp->set_postfork_issues(Statistics->PostForkIssues);
+    rsp->set_destroy_queued(Statistics->DestroyQueued);
+    rsp->set_destroy_async(Statistics->DestroyAsyncDone);
+    rsp->set_destroy_async_failed(Statistics->DestroyAsyncFailed);
 
     rsp->set_stream_rotate_bytes(Statistics->LogRotateBytes);
     rsp->set_stream_rotate_errors(Statistics->LogRotateErrors);
@@ -2017,6 +2185,30 @@ noinline static TError GetSystemProperties(const rpc::TGetSystemRequest *, rpc::
     rsp->set_network_problems(Statistics->NetworkProblems);
     rsp->set_network_repairs(Statistics->NetworkRepairs);
 
+    for (auto &it: TEventQueue::DelayHgrams()) {
+        auto hgram = rsp->add_event_delay_hgram();
+        hgram->set_name(it.first);
+        hgram->set_value(it.second->Format());
+    }
+
+    for (auto &it: TContainer::StartTimingHgrams()) {
+        auto hgram = rsp->add_start_timing_hgram();
+        hgram->set_name(it.first);
+        hgram->set_value(it.second->Format());
+    }
+
+    std::lock_guard<std::mutex> guard(StartupProfileMutex);
+    for (auto &phase: StartupPhases) {
+        auto p = rsp->add_startup_phase();
+        p->set_name(phase.Name);
+        p->set_time_ms(phase.TimeMs);
+    }
+    for (auto &phase: StartupRestoreOutliers) {
+        auto p = rsp->add_startup_restore_outlier();
+        p->set_name(phase.Name);
+        p->set_time_ms(phase.TimeMs);
+    }
+
     return OK;
 }
 
@@ -2052,11 +2244,11 @@ noinline static TError ClearStatistics(const rpc::TClearStatisticsRequest *req)
          if (!it->second.Resetable)
             return TError(EError::InvalidValue, "Field cannot be cleared");
 
-        Statistics->*(it->second.Member) = 0;
+        it->second.Reset();
     } else {
         for (const auto &it : PortoStatMembers) {
             if (it.second.Resetable)
-                Statistics->*(it.second.Member) = 0;
+                it.second.Reset();
         }
     }
 
@@ -2118,7 +2310,7 @@ void TRequest::Handle() {
         specRequest = true;
     }
     else if (Req.has_updatefromspec()) {
-        error = UpdateFromSpec(Req.updatefromspec());
+        error = UpdateFromSpec(Req.updatefromspec(), *rsp.mutable_updatefromspec());
         specRequest = true;
     }
     else if (Req.has_listcontainersby()) {
@@ -2143,6 +2335,8 @@ void TRequest::Handle() {
         error = GetContainerCombined(Req.get(), rsp);
     else if (Req.has_start())
         error = StartContainer(Req.start());
+    else if (Req.has_startcontainers())
+        error = StartContainers(Req.startcontainers(), *rsp.mutable_startcontainers());
     else if (Req.has_stop())
         error = StopContainer(Req.stop());
     else if (Req.has_pause())
@@ -4,6 +4,12 @@
 #include "util/proc.hpp"
 #include "client.hpp"
 #include "container.hpp"
+#include "ringlog.hpp"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <mutex>
 
 extern "C" {
 #include <sys/ioctl.h>
@@ -193,6 +199,97 @@ TError TStdStream::OpenInside(const TContainer &container) {
     return error;
 }
 
+static bool ReadRingHeader(const TFile &file, struct porto_ring_header &hdr) {
+    return pread(file.Fd, &hdr, sizeof(hdr), 0) == sizeof(hdr) &&
+           hdr.magic == PORTO_RING_MAGIC && hdr.size &&
+           hdr.head <= hdr.tail && hdr.tail - hdr.head <= hdr.size;
+}
+
+bool TStdStream::UseRing(const TContainer &container) const {
+    return Stream && Outside && !IsNull() && !IsRedirect() && Limit &&
+           !container.IsMeta() && config().container().std_stream_ring();
+}
+
+/* Keeps content if file already is ring of the same size, plain log is converted */
+TError TStdStream::OpenRing(const TContainer &container, TFile &file) const {
+    struct porto_ring_header hdr;
+    TPath path = ResolveOutside(container);
+    std::string tail;
+    struct stat st;
+    TError error;
+
+    error = file.Create(path, O_RDWR | O_CREAT | O_CLOEXEC | O_NOCTTY | O_NOFOLLOW, 0660);
+    if (error)
+        return error;
+
+    error = file.Chown(container.TaskCred);
+    if (error)
+        return error;
+
+    if (ReadRingHeader(file, hdr)) {
+        if (hdr.size == Limit)
+            return OK;
+    } else {
+        /* Keep last Limit bytes of plain log written before ring was enabled */
+        if (fstat(file.Fd, &st))
+            return TError::System("fstat {}", path);
+        if (st.st_size) {
+            off_t offset = std::max((off_t)0, st.st_size - (off_t)Limit);
+            tail.resize(st.st_size - offset);
+            ssize_t result = pread(file.Fd, &tail[0], tail.size(), offset);
+            if (result < 0)
+                return TError::System("pread {}", path);
+            tail.resize(result);
+        }
+    }
+
+    hdr.magic = PORTO_RING_MAGIC;
+    hdr.size = Limit;
+    hdr.head = 0;
+    hdr.tail = tail.size();
+
+    error = file.Truncate(0);
+    if (!error)
+        error = file.Truncate(PORTO_RING_DATA + Limit);
+    if (!error && tail.size() &&
+            pwrite(file.Fd, tail.c_str(), tail.size(), PORTO_RING_DATA) != (ssize_t)tail.size())
+        error = TError::System("pwrite {}", path);
+    if (!error && pwrite(file.Fd, &hdr, sizeof(hdr), 0) != sizeof(hdr))
+        error = TError::System("pwrite {}", path);
+
+    return error;
+}
+
+/* Drops data overwritten while reading */
+static TError ReadRing(const TFile &file, uint64_t offset, uint64_t limit, std::string &text) {
+    struct porto_ring_header hdr;
+    uint64_t done = 0;
+
+    if (!ReadRingHeader(file, hdr))
+        return TError(EError::InvalidData, "Broken ring header");
+
+    text.resize(limit);
+    while (done < limit) {
+        uint64_t pos = (offset + done) % hdr.size;
+        uint64_t chunk = std::min(limit - done, hdr.size - pos);
+        ssize_t result = pread(file.Fd, &text[done], chunk, PORTO_RING_DATA + pos);
+        if (result < 0)
+            return TError::System("pread");
+        if (!result)
+            break;
+        done += result;
+    }
+    text.resize(done);
+
+    if (!ReadRingHeader(file, hdr))
+        return TError(EError::InvalidData, "Broken ring header");
+
+    if (hdr.head > offset)
+        text.erase(0, std::min(hdr.head - offset, (uint64_t)text.size()));
+
+    return OK;
+}
+
 TError TStdStream::Remove(const TContainer &container) {
     /* Custom stdout/stderr files are not removed */
     if (!Outside || Path.IsAbsolute())
@@ -208,12 +305,48 @@ TError TStdStream::Remove(const TContainer &container) {
     return error;
 }
 
-TError TStdStream::Rotate(const TContainer &container) {
-    TPath path = ResolveOutside(container);
-    if (path.IsEmpty() || !path.IsRegularStrict())
+TError TStdStream::Rotate(const TContainer &container, TFile &file) {
+    struct porto_ring_header hdr;
+    struct stat st;
+    TError error;
+
+    /* Ring never grows, just follow its head */
+    if (file && ReadRingHeader(file, hdr)) {
+        Offset = hdr.head;
+        return OK;
+    }
+
+    /* Reopen if file was removed or replaced */
+    if (file && (fstat(file.Fd, &st) || !st.st_nlink))
+        file.Close();
+
+    if (!file) {
+        TPath path = ResolveOutside(container);
+        if (path.IsEmpty() || !path.IsRegularStrict())
+            return OK;
+        error = file.Open(path, O_RDWR | O_CLOEXEC | O_NOCTTY | O_NOFOLLOW);
+        if (!error && fstat(file.Fd, &st))
+            error = TError::System("fstat {}", path);
+        if (error) {
+            file.Close();
+            Statistics->LogRotateErrors++;
+            return error;
+        }
+
+        if (ReadRingHeader(file, hdr)) {
+            Offset = hdr.head;
+            return OK;
+        }
+    }
+
+    if (!S_ISREG(st.st_mode))
+        return OK;
+
+    if ((uint64_t)st.st_size <= Limit)
         return OK;
+
     off_t loss;
-    TError error = path.RotateLog(Limit, loss);
+    error = file.RotateLog(Limit, loss);
     if (error) {
         Statistics->LogRotateErrors++;
         return error;
@@ -223,6 +356,55 @@ TError TStdStream::Rotate(const TContainer &container) {
     return OK;
 }
 
+/* Running containers and their open stdout and stderr */
+struct TRotateEntry {
+    std::weak_ptr<TContainer> Container;
+    std::mutex Mutex;
+    TFile Stdout;
+    TFile Stderr;
+};
+
+static std::mutex RotateMutex;
+static std::map<int, std::shared_ptr<TRotateEntry>> RotateEntries;
+
+void TStdStream::TrackRotate(std::shared_ptr<TContainer> container) {
+    auto entry = std::make_shared<TRotateEntry>();
+    entry->Container = container;
+    std::lock_guard<std::mutex> guard(RotateMutex);
+    RotateEntries[container->Id] = entry;
+}
+
+void TStdStream::UntrackRotate(const TContainer &container) {
+    std::lock_guard<std::mutex> guard(RotateMutex);
+    RotateEntries.erase(container.Id);
+}
+
+void TStdStream::RotateAll() {
+    std::vector<std::pair<std::shared_ptr<TContainer>, std::shared_ptr<TRotateEntry>>> entries;
+
+    /* Do not hold RotateMutex for IO, state changes wait for it */
+    std::unique_lock<std::mutex> lock(RotateMutex);
+    for (auto it = RotateEntries.begin(); it != RotateEntries.end(); ) {
+        auto ct = it->second->Container.lock();
+        if (!ct) {
+            it = RotateEntries.erase(it);
+            continue;
+        }
+        entries.emplace_back(ct, it->second);
+        ++it;
+    }
+    lock.unlock();
+
+    for (auto &it: entries) {
+        auto &ct = it.first;
+        auto &entry = it.second;
+        std::lock_guard<std::mutex> guard(entry->Mutex);
+        /* fstat of open file is cheap, rotate only files above limit */
+        (void)ct->Stdout.Rotate(*ct, entry->Stdout);
+        (void)ct->Stderr.Rotate(*ct, entry->Stderr);
+    }
+}
+
 TError TStdStream::Read(const TContainer &container, std::string &text,
                         const std::string &range) const {
     std::string off = "", lim = "";
@@ -247,13 +429,28 @@ TError TStdStream::Read(const TContainer &container, std::string &text,
             off = range;
     }
 
+    TFile file;
+
+    error = file.Open(path, O_RDONLY | O_NOCTTY | O_NOFOLLOW | O_CLOEXEC);
+    if (error)
+        return error;
+
+    if (file.RealPath() != path)
+        return TError(EError::Permission, "Real path doesn't match: " + path.ToString());
+
+    /* Offsets in ring are logical, no need to track rotations */
+    struct porto_ring_header hdr;
+    bool ring = ReadRingHeader(file, hdr);
+    uint64_t base = ring ? hdr.head : Offset;
+    uint64_t size = ring ? hdr.tail - hdr.head : lseek(file.Fd, 0, SEEK_END);
+
     if (off.size()) {
         error = StringToUint64(off, offset);
         if (error)
             return error;
-        if (offset < Offset)
-            return TError(EError::InvalidData, "Requested offset lower than current {}", Offset);
-        offset -= Offset;
+        if (offset < base)
+            return TError(EError::InvalidData, "Requested offset lower than current {}", base);
+        offset -= base;
     } else
         offset = 0;
 
@@ -264,17 +461,6 @@ TError TStdStream::Read(const TContainer &container, std::string &text,
     } else
         limit = Limit;
 
-    TFile file;
-
-    error = file.Open(path, O_RDONLY | O_NOCTTY | O_NOFOLLOW | O_CLOEXEC);
-    if (error)
-        return error;
-
-    if (file.RealPath() != path)
-        return TError(EError::Permission, "Real path doesn't match: " + path.ToString());
-
-    uint64_t size = lseek(file.Fd, 0, SEEK_END);
-
     if (size <= offset)
         limit = 0;
     else if (size <= offset + limit)
@@ -290,6 +476,9 @@ TError TStdStream::Read(const TContainer &container, std::string &text,
         L_WRN("StdStream read limit exceeded, response truncated");
     }
 
+    if (limit && ring)
+        return ReadRing(file, base + offset, limit, text);
+
     if (limit) {
         text.resize(limit);
         ssize_t result = pread(file.Fd, &text[0], limit, offset);
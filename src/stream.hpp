@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include <util/path.hpp>
 
 class TContainer;
@@ -33,9 +34,23 @@ public:
     TError OpenOutside(const TContainer &container, const TClient &client);
     TError OpenInside(const TContainer &container);
 
+    /* Circular log written by portoinit --ring, see ringlog.hpp */
+    bool UseRing(const TContainer &container) const;
+    TError OpenRing(const TContainer &container, TFile &file) const;
+
     TError Remove(const TContainer &container);
 
-    TError Rotate(const TContainer &container);
+    TError Rotate(const TContainer &container, TFile &file);
+    TError Rotate(const TContainer &container) {
+        TFile file;
+        return Rotate(container, file);
+    }
+
+    /* Rotation of running containers logs, files are kept open */
+    static void TrackRotate(std::shared_ptr<TContainer> container);
+    static void UntrackRotate(const TContainer &container);
+    static void RotateAll();
+
     TError Read(const TContainer &container, std::string &text,
                 const std::string &range = "") const;
 };
@@ -21,6 +21,7 @@ extern "C" {
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <sys/ptrace.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <wordexp.h>
@@ -48,6 +49,21 @@ std::list<std::string> IpcSysctls = {
     "kernel.sem",
 };
 
+static const char *TaskStepNames[] = {
+    "fork",
+    "cgroups",
+    "streams",
+    "namespaces",
+    "clone",
+    "configure",
+    "wakeup",
+    "autoconf",
+    "exec",
+};
+
+static_assert(sizeof(TaskStepNames) / sizeof(TaskStepNames[0]) == (int)ETaskStep::Count,
+              "TaskStepNames mismatch");
+
 extern bool SupportCgroupNs;
 extern bool EnableDockerMode;
 
@@ -86,6 +102,33 @@ void TTaskEnv::ReportPid(pid_t pid) {
     ReportStage++;
 }
 
+void TTaskEnv::MarkStep(ETaskStep step) {
+    if (StepTimes)
+        StepTimes[(int)step] = GetCurrentTimeUs();
+}
+
+/* Converts child timestamps into start timings of container */
+void TTaskEnv::ReportSteps(uint64_t start) {
+    uint64_t prev = start;
+
+    if (!StepTimes)
+        return;
+
+    for (int step = 0; step < (int)ETaskStep::Count; step++) {
+        uint64_t time = StepTimes[step];
+        if (!time || time < prev)
+            continue;
+        CT->AddStartTiming(std::string("task_") + TaskStepNames[step], time - prev);
+        prev = time;
+    }
+
+    /* Until parent got exec or error report */
+    CT->AddStartTiming("task_report", GetCurrentTimeUs() - prev);
+
+    munmap(StepTimes, sizeof(uint64_t) * (int)ETaskStep::Count);
+    StepTimes = nullptr;
+}
+
 void TTaskEnv::Abort(const TError &error) {
     TError error2;
 
@@ -203,6 +246,7 @@ TError TTaskEnv::ChildExec() {
         };
         SetDieOnParentExit(0);
         TFile::Close({0, 1, 2});
+        MarkStep(ETaskStep::Exec);
         fexecve(PortoInit.Fd, (char *const *)args, envp);
         return TError::System("cannot exec portoinit");
     }
@@ -263,6 +307,7 @@ TError TTaskEnv::ChildExec() {
     }
 
     L("Exec '{}'", argv[0]);
+    MarkStep(ETaskStep::Exec);
     execvpe(argv[0], (char *const *)argv.data(), envp);
 
     if (errno == EAGAIN)
@@ -528,6 +573,8 @@ void TTaskEnv::StartChild() {
     L("StartChild");
     TError error;
 
+    MarkStep(ETaskStep::Clone);
+
     if (TripleFork) {
         /* Die together with parent who report WPid */
         SetDieOnParentExit(SIGKILL);
@@ -546,11 +593,15 @@ void TTaskEnv::StartChild() {
     if (error)
         Abort(error);
 
+    MarkStep(ETaskStep::Configure);
+
     /* Wait for Wakeup */
     error = Sock.RecvZero();
     if (error)
         Abort(error);
 
+    MarkStep(ETaskStep::Wakeup);
+
     MasterSock.Close();
 
     /* Reset signals before exec, signal block already lifted */
@@ -560,6 +611,8 @@ void TTaskEnv::StartChild() {
     if (error)
         Abort(error);
 
+    MarkStep(ETaskStep::Autoconf);
+
     error = ChildExec();
     Abort(error);
 }
@@ -640,6 +693,13 @@ TError TTaskEnv::Start() {
     if (error)
         return error;
 
+    StepTimes = (uint64_t *)mmap(nullptr, sizeof(uint64_t) * (int)ETaskStep::Count,
+                                 PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (StepTimes == MAP_FAILED)
+        StepTimes = nullptr;
+
+    uint64_t startTime = GetCurrentTimeUs();
+
     // we want our child to have portod master as parent, so we
     // are doing double fork here (fork + clone);
     // we also need to know child pid so we are using pipe to send it back
@@ -651,10 +711,13 @@ TError TTaskEnv::Start() {
         Sock.Close();
         MasterSock.Close();
         L("Can't spawn child: {}", error);
+        ReportSteps(startTime);
         return error;
     }
 
     if (!task.Pid) {
+        MarkStep(ETaskStep::Fork);
+
         if (config().container().ptrace_on_start()) {
             pid_t traceePid = fork();
             if (traceePid < 0)
@@ -699,14 +762,24 @@ TError TTaskEnv::Start() {
 
         (void)setsid();
 
+        /* Ring writers stay out of freezer to drain pipes after container is killed */
+        error = OpenRingStreams();
+        if (error)
+            Abort(error);
+
         L("Attach to cgroups");
         // move to target cgroups
         for (auto &cg : Cgroups) {
+            /* Task will be cloned right into cgroup2 */
+            if (Cgroup2Fd >= 0 && cg.IsCgroup2())
+                continue;
             error = cg.Attach(GetPid());
             if (error)
                 Abort(error);
         }
 
+        MarkStep(ETaskStep::Cgroups);
+
         error = TPath("/proc/self/oom_score_adj").WriteAll(std::to_string(CT->OomScoreAdj));
         if (error && CT->OomScoreAdj)
             Abort(error);
@@ -737,13 +810,19 @@ TError TTaskEnv::Start() {
         if (error)
             Abort(error);
 
-        error = CT->Stdout.OpenOutside(*CT, *Client);
-        if (error)
-            Abort(error);
+        if (!CT->Stdout.UseRing(*CT)) {
+            error = CT->Stdout.OpenOutside(*CT, *Client);
+            if (error)
+                Abort(error);
+        }
 
-        error = CT->Stderr.OpenOutside(*CT, *Client);
-        if (error)
-            Abort(error);
+        if (!CT->Stderr.UseRing(*CT)) {
+            error = CT->Stderr.OpenOutside(*CT, *Client);
+            if (error)
+                Abort(error);
+        }
+
+        MarkStep(ETaskStep::Streams);
 
         L("Enter namespaces");
 
@@ -781,6 +860,8 @@ TError TTaskEnv::Start() {
         if (error)
             Abort(error);
 
+        MarkStep(ETaskStep::Namespaces);
+
         if (TripleFork) {
             /*
              * Enter into pid-namespace. fork() hangs in libc if child pid
@@ -829,8 +910,25 @@ TError TTaskEnv::Start() {
         if (config().container().ptrace_on_start())
             cloneFlags |= CLONE_PTRACE;
 
-        L("clone, flags: {}", cloneFlags);
-        pid_t clonePid = clone(ChildFn, stack + sizeof(stack), cloneFlags, this);
+        pid_t clonePid = -1;
+
+        if (Cgroup2Fd >= 0) {
+            L("clone3 into cgroup2, flags: {}", cloneFlags);
+            clonePid = Clone3(cloneFlags & ~CSIGNAL, cloneFlags & CSIGNAL, Cgroup2Fd);
+            if (!clonePid)
+                _exit(ChildFn(this));
+            if (clonePid < 0) {
+                L("Cannot clone3 into cgroup2: {}", TError::System("clone3"));
+                error = AttachCgroup2();
+                if (error)
+                    Abort(error);
+            }
+        }
+
+        if (clonePid < 0) {
+            L("clone, flags: {}", cloneFlags);
+            clonePid = clone(ChildFn, stack + sizeof(stack), cloneFlags, this);
+        }
 
         if (clonePid < 0) {
             TError error(errno == ENOMEM ?
@@ -878,6 +976,8 @@ TError TTaskEnv::Start() {
         goto kill_all;
     }
 
+    CT->IndexExitPids();
+
     /* Ack WPid */
     error = MasterSock.SendZero();
     if (error)
@@ -941,6 +1041,8 @@ TError TTaskEnv::Start() {
         goto kill_all;
     }
 
+    ReportSteps(startTime);
+
     return OK;
 
 kill_all:
@@ -949,6 +1051,7 @@ kill_all:
         task.Kill(SIGKILL);
         task.Wait();
     }
+    ReportSteps(startTime);
     CT->Task.Pid = 0;
     CT->TaskVPid = 0;
     CT->WaitTask.Pid = 0;
@@ -956,6 +1059,98 @@ kill_all:
     return error;
 }
 
+TError TTaskEnv::StartRingWriter(TStdStream &stream) {
+    TFile ring;
+    int pipefd[2];
+    TError error;
+
+    L("Start ring writer for {}", stream.Stream);
+
+    error = stream.OpenRing(*CT, ring);
+    if (error)
+        return error;
+
+    if (pipe2(pipefd, O_CLOEXEC))
+        return TError::System("pipe2");
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        error = TError::System("fork");
+        close(pipefd[0]);
+        close(pipefd[1]);
+        return error;
+    }
+
+    if (!pid) {
+        const char *argv[] = { "portoinit", "--ring", NULL };
+        const char *envp[] = { NULL };
+
+        SetDieOnParentExit(0);
+
+        /* Charge writer to container, it exits at eof after container death */
+        for (auto &cg: Cgroups) {
+            if (cg.IsCgroup2() || (cg.Subsystem->Controllers & CGROUP_FREEZER) ||
+                    !(cg.Subsystem->Controllers & (CGROUP_MEMORY | CGROUP_CPU | CGROUP_CPUACCT)))
+                continue;
+            if (cg.Attach(GetPid()))
+                _exit(EXIT_FAILURE);
+        }
+
+        if (dup2(pipefd[0], 0) == 0 && dup2(ring.Fd, 1) == 1 &&
+                !PortoInitCapabilities.ApplyLimit()) {
+            TFile::CloseAllExcept({0, 1, PortoInit.Fd});
+            fexecve(PortoInit.Fd, (char *const *)argv, (char *const *)envp);
+        }
+        _exit(EXIT_FAILURE);
+    }
+
+    close(pipefd[0]);
+    if (dup2(pipefd[1], stream.Stream) < 0)
+        error = TError::System("dup2");
+    close(pipefd[1]);
+
+    return error;
+}
+
+/* Fallback for clone3, path to cgroup might be unreachable after chroot */
+TError TTaskEnv::AttachCgroup2() {
+    TFile procs;
+    TError error;
+
+    int fd = openat(Cgroup2Fd, "cgroup.procs", O_WRONLY | O_CLOEXEC | O_NOCTTY);
+    if (fd < 0)
+        return TError::System("Cannot open cgroup.procs");
+    procs.SetFd = fd;
+
+    error = procs.WriteAll(std::to_string(GetPid()));
+    if (error)
+        return TError(error, "Cannot attach to cgroup2");
+
+    return OK;
+}
+
+TError TTaskEnv::OpenRingStreams() {
+    TError error;
+
+    if (CT->Stdout.UseRing(*CT)) {
+        error = StartRingWriter(CT->Stdout);
+        if (error)
+            return error;
+    }
+
+    if (CT->Stderr.UseRing(*CT)) {
+        /* Two writers cannot share one ring */
+        if (CT->Stdout.UseRing(*CT) &&
+                CT->Stderr.ResolveOutside(*CT) == CT->Stdout.ResolveOutside(*CT)) {
+            if (dup2(CT->Stdout.Stream, CT->Stderr.Stream) < 0)
+                return TError::System("dup2");
+        } else
+            error = StartRingWriter(CT->Stderr);
+    }
+
+    return error;
+}
+
 void TTaskEnv::ExecPortoinit(pid_t pid) {
     auto pid_ = std::to_string(pid);
     const char * argv[] = {
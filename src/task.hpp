@@ -13,6 +13,21 @@
 
 class TContainer;
 class TClient;
+class TStdStream;
+
+/* Steps of task start done by forked children */
+enum class ETaskStep {
+    Fork,
+    Cgroups,
+    Streams,
+    Namespaces,
+    Clone,
+    Configure,
+    Wakeup,
+    Autoconf,
+    Exec,
+    Count,
+};
 
 struct TTaskEnv {
     std::shared_ptr<TContainer> CT;
@@ -36,6 +51,7 @@ struct TTaskEnv {
     std::vector<std::string> Autoconf;
     bool NewMountNs;
     std::vector<TCgroup> Cgroups;
+    int Cgroup2Fd = -1;     /* clone task right into this cgroup2 */
     TCred Cred;
     uid_t LoginUid;
 
@@ -43,6 +59,11 @@ struct TTaskEnv {
     TUnixSocket Sock2, MasterSock2;
     int ReportStage = 0;
 
+    /* Step timestamps, shared page is written by children */
+    uint64_t *StepTimes = nullptr;
+    void MarkStep(ETaskStep step);
+    void ReportSteps(uint64_t start);
+
     TError OpenNamespaces(TContainer &ct);
 
     TError Start();
@@ -62,6 +83,10 @@ struct TTaskEnv {
     void Abort(const TError &error);
 
     void ExecPortoinit(pid_t pid);
+
+    TError StartRingWriter(TStdStream &stream);
+    TError OpenRingStreams();
+    TError AttachCgroup2();
 };
 
 extern std::list<std::string> IpcSysctls;
@@ -22,6 +22,30 @@ __thread char ReqId[9];
 TStatistics *Statistics = nullptr;
 std::map<std::string, TStatistic> PortoStatMembers;
 
+__thread int StatCounterSlot = -1;
+static std::atomic<unsigned> NextStatCounterSlot(0);
+
+int AllocStatCounterSlot() {
+    return NextStatCounterSlot++ % STAT_COUNTER_SLOTS;
+}
+
+uint64_t TStatistic::Get() const {
+    if (Counter)
+        return (Statistics->*Counter).Get();
+    return Statistics->*Member;
+}
+
+void TStatistic::Reset() const {
+    if (Counter)
+        (Statistics->*Counter).Reset();
+    else
+        Statistics->*Member = 0;
+}
+
+static void MoveLegacyStat(std::atomic<uint64_t> &legacy, TStatCounter &counter) {
+    counter.Add(legacy.exchange(0));
+}
+
 void InitStatistics() {
     TError error;
     TFile file;
@@ -40,6 +64,13 @@ void InitStatistics() {
                                      file.Fd, 0);
     PORTO_ASSERT(Statistics != nullptr);
 
+    MoveLegacyStat(Statistics->LegacyLogLines, Statistics->LogLines);
+    MoveLegacyStat(Statistics->LegacyLogBytes, Statistics->LogBytes);
+    MoveLegacyStat(Statistics->LegacyRequestsQueued, Statistics->RequestsQueued);
+    MoveLegacyStat(Statistics->LegacyRequestsCompleted, Statistics->RequestsCompleted);
+    MoveLegacyStat(Statistics->LegacySpecRequestsCompleted, Statistics->SpecRequestsCompleted);
+    MoveLegacyStat(Statistics->LegacyLockOperationsCount, Statistics->LockOperationsCount);
+
     PortoStatMembers.insert(std::make_pair("spawned", TStatistic(&TStatistics::PortoStarts)));
     PortoStatMembers.insert(std::make_pair("errors", TStatistic(&TStatistics::Errors)));
     PortoStatMembers.insert(std::make_pair("cgerrors", TStatistic(&TStatistics::CgErrors)));
@@ -52,8 +83,16 @@ void InitStatistics() {
     PortoStatMembers.insert(std::make_pair("queued_statuses", TStatistic(&TStatistics::QueuedStatuses, false)));
     PortoStatMembers.insert(std::make_pair("queued_events", TStatistic(&TStatistics::QueuedEvents, false)));
     PortoStatMembers.insert(std::make_pair("remove_dead", TStatistic(&TStatistics::RemoveDead)));
+    PortoStatMembers.insert(std::make_pair("destroy_queued", TStatistic(&TStatistics::DestroyQueued, false)));
+    PortoStatMembers.insert(std::make_pair("destroy_async", TStatistic(&TStatistics::DestroyAsyncDone)));
+    PortoStatMembers.insert(std::make_pair("destroy_async_failed", TStatistic(&TStatistics::DestroyAsyncFailed)));
     PortoStatMembers.insert(std::make_pair("restore_failed", TStatistic(&TStatistics::ContainerLost)));
     PortoStatMembers.insert(std::make_pair("start_timeouts", TStatistic(&TStatistics::StartTimeouts)));
+    PortoStatMembers.insert(std::make_pair("cgroup_pool_created", TStatistic(&TStatistics::CgroupPoolCreated)));
+    PortoStatMembers.insert(std::make_pair("cgroup_pool_taken", TStatistic(&TStatistics::CgroupPoolTaken)));
+    PortoStatMembers.insert(std::make_pair("warm_pool_idle", TStatistic(&TStatistics::WarmPoolIdle, false)));
+    PortoStatMembers.insert(std::make_pair("warm_pool_claimed", TStatistic(&TStatistics::WarmPoolClaimed)));
+    PortoStatMembers.insert(std::make_pair("warm_pool_missed", TStatistic(&TStatistics::WarmPoolMissed)));
     PortoStatMembers.insert(std::make_pair("l3stat_lost", TStatistic(&TStatistics::L3StatLost)));
     PortoStatMembers.insert(std::make_pair("epoll_sources", TStatistic(&TStatistics::EpollSources, false)));
     PortoStatMembers.insert(std::make_pair("log_lines", TStatistic(&TStatistics::LogLines, false)));
@@ -103,6 +142,7 @@ void InitStatistics() {
     PortoStatMembers.insert(std::make_pair("spec_requests_longer_30s", TStatistic(&TStatistics::SpecRequestsLonger30s)));
     PortoStatMembers.insert(std::make_pair("spec_requests_longer_5m", TStatistic(&TStatistics::SpecRequestsLonger5m)));
     PortoStatMembers.insert(std::make_pair("spec_requests_failed", TStatistic(&TStatistics::SpecRequestsFailed)));
+    PortoStatMembers.insert(std::make_pair("spec_updates_unchanged", TStatistic(&TStatistics::SpecUpdatesUnchanged)));
     PortoStatMembers.insert(std::make_pair("spec_fail_invalid_value", TStatistic(&TStatistics::SpecRequestsFailedInvalidValue)));
     PortoStatMembers.insert(std::make_pair("spec_fail_unknown", TStatistic(&TStatistics::SpecRequestsFailedUnknown)));
     PortoStatMembers.insert(std::make_pair("spec_fail_no_container", TStatistic(&TStatistics::SpecRequestsFailedContainerDoesNotExist)));
@@ -111,6 +151,12 @@ void InitStatistics() {
     PortoStatMembers.insert(std::make_pair("lock_operations_longer_3s", TStatistic(&TStatistics::LockOperationsLonger3s)));
     PortoStatMembers.insert(std::make_pair("lock_operations_longer_30s", TStatistic(&TStatistics::LockOperationsLonger30s)));
     PortoStatMembers.insert(std::make_pair("lock_operations_longer_5m", TStatistic(&TStatistics::LockOperationsLonger5m)));
+    PortoStatMembers.insert(std::make_pair("kv_saves_queued", TStatistic(&TStatistics::KvSavesQueued)));
+    PortoStatMembers.insert(std::make_pair("kv_saves_coalesced", TStatistic(&TStatistics::KvSavesCoalesced)));
+    PortoStatMembers.insert(std::make_pair("kv_flushes", TStatistic(&TStatistics::KvFlushes)));
+    PortoStatMembers.insert(std::make_pair("kv_flush_latency_max_ms", TStatistic(&TStatistics::KvFlushLatencyMax)));
+    PortoStatMembers.insert(std::make_pair("containers_lazy", TStatistic(&TStatistics::ContainersLazy, false)));
+    PortoStatMembers.insert(std::make_pair("containers_lazy_loaded", TStatistic(&TStatistics::ContainersLazyLoaded)));
 }
 
 TFile LogFile;
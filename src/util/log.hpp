@@ -15,6 +15,44 @@ void OpenLog(const TPath &path);
 void WriteLog(const char *prefix, const std::string &log_msg);
 void Stacktrace();
 
+constexpr unsigned STAT_COUNTER_SLOTS = 32;
+
+extern __thread int StatCounterSlot;
+int AllocStatCounterSlot();
+
+/*
+ * Counter with per-thread slots in separate cache lines, slots are summed on
+ * read. Decrements wrap around in slot but sum is still correct.
+ */
+struct TStatCounter {
+    struct alignas(64) TSlot {
+        std::atomic<uint64_t> Value;
+    } Slots[STAT_COUNTER_SLOTS];
+
+    void Add(uint64_t value) {
+        if (StatCounterSlot < 0)
+            StatCounterSlot = AllocStatCounterSlot();
+        Slots[StatCounterSlot].Value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Get() const {
+        uint64_t sum = 0;
+        for (auto &slot: Slots)
+            sum += slot.Value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    void Reset() {
+        for (auto &slot: Slots)
+            slot.Value.store(0, std::memory_order_relaxed);
+    }
+
+    void operator++(int) { Add(1); }
+    void operator--(int) { Add(-1); }
+    void operator+=(uint64_t value) { Add(value); }
+    operator uint64_t() const { return Get(); }
+};
+
 struct TStatistics {
     /* --- add new fields at the end --- */
     std::atomic<uint64_t> PortoStarts;
@@ -30,8 +68,8 @@ struct TStatistics {
     std::atomic<uint64_t> ContainersFailedStart;
     std::atomic<uint64_t> ContainersOOM;
     std::atomic<uint64_t> RemoveDead;
-    std::atomic<uint64_t> LogLines;
-    std::atomic<uint64_t> LogBytes;
+    std::atomic<uint64_t> LegacyLogLines; /* moved into TStatCounter */
+    std::atomic<uint64_t> LegacyLogBytes; /* moved into TStatCounter */
     std::atomic<uint64_t> LogRotateBytes;
     std::atomic<uint64_t> LogRotateErrors;
     std::atomic<uint64_t> ContainerLost;
@@ -39,15 +77,15 @@ struct TStatistics {
     std::atomic<uint64_t> ContainersCount;
     std::atomic<uint64_t> VolumesCount;
     std::atomic<uint64_t> ClientsCount;
-    std::atomic<uint64_t> RequestsQueued;
-    std::atomic<uint64_t> RequestsCompleted;
+    std::atomic<uint64_t> LegacyRequestsQueued; /* moved into TStatCounter */
+    std::atomic<uint64_t> LegacyRequestsCompleted; /* moved into TStatCounter */
     std::atomic<uint64_t> RequestsLonger1s;
     std::atomic<uint64_t> RequestsLonger3s;
     std::atomic<uint64_t> RequestsLonger30s;
     std::atomic<uint64_t> RequestsLonger5m;
     std::atomic<uint64_t> ClientsConnected;
     std::atomic<uint64_t> RequestsFailed;
-    std::atomic<uint64_t> SpecRequestsCompleted;
+    std::atomic<uint64_t> LegacySpecRequestsCompleted; /* moved into TStatCounter */
     std::atomic<uint64_t> SpecRequestsLonger1s;
     std::atomic<uint64_t> SpecRequestsLonger3s;
     std::atomic<uint64_t> SpecRequestsLonger30s;
@@ -82,7 +120,7 @@ struct TStatistics {
     std::atomic<uint64_t> FailInvalidNetaddr;
     std::atomic<uint64_t> PostForkIssues;
 
-    std::atomic<uint64_t> LockOperationsCount;
+    std::atomic<uint64_t> LegacyLockOperationsCount; /* moved into TStatCounter */
     std::atomic<uint64_t> LockOperationsLonger1s;
     std::atomic<uint64_t> LockOperationsLonger3s;
     std::atomic<uint64_t> LockOperationsLonger30s;
@@ -91,11 +129,35 @@ struct TStatistics {
     std::atomic<uint64_t> StartTimeouts;
 
     std::atomic<uint64_t> L3StatLost;
+
+    /* Hot counters, legacy values are moved here at start */
+    TStatCounter LogLines;
+    TStatCounter LogBytes;
+    TStatCounter RequestsQueued;
+    TStatCounter RequestsCompleted;
+    TStatCounter SpecRequestsCompleted;
+    TStatCounter LockOperationsCount;
+    std::atomic<uint64_t> KvSavesQueued;
+    std::atomic<uint64_t> KvSavesCoalesced;
+    std::atomic<uint64_t> KvFlushes;
+    std::atomic<uint64_t> KvFlushLatencyMax;
+    std::atomic<uint64_t> ContainersLazy;
+    std::atomic<uint64_t> ContainersLazyLoaded;
+    std::atomic<uint64_t> CgroupPoolCreated;
+    std::atomic<uint64_t> CgroupPoolTaken;
+    std::atomic<uint64_t> DestroyQueued;
+    std::atomic<uint64_t> DestroyAsyncDone;
+    std::atomic<uint64_t> DestroyAsyncFailed;
+    std::atomic<uint64_t> SpecUpdatesUnchanged;
+    std::atomic<uint64_t> WarmPoolIdle;
+    std::atomic<uint64_t> WarmPoolClaimed;
+    std::atomic<uint64_t> WarmPoolMissed;
     /* --- add new fields at the end --- */
 };
 
 struct TStatistic {
-    std::atomic<uint64_t> TStatistics:: *Member;
+    std::atomic<uint64_t> TStatistics:: *Member = nullptr;
+    TStatCounter TStatistics:: *Counter = nullptr;
     bool Resetable = true;
     bool TimeStat = false;
 
@@ -104,6 +166,14 @@ struct TStatistic {
         Resetable(resetable),
         TimeStat(timeStat)
         {}
+
+    TStatistic(TStatCounter TStatistics:: *counter, bool resetable = true) :
+        Counter(counter),
+        Resetable(resetable)
+        {}
+
+    uint64_t Get() const;
+    void Reset() const;
 };
 
 extern std::map<std::string, TStatistic> PortoStatMembers;
@@ -115,11 +185,12 @@ void InitStatistics();
 static inline void ResetStatistics() {
     Statistics->ContainersCount = 0;
     Statistics->ContainersTainted = 0;
+    Statistics->ContainersLazy = 0;
     Statistics->ClientsCount = 0;
     Statistics->VolumesCount = 0;
     Statistics->VolumeLinks = 0;
     Statistics->VolumeLinksMounted = 0;
-    Statistics->RequestsQueued = 0;
+    Statistics->RequestsQueued.Reset();
     Statistics->NetworksCount = 0;
     Statistics->LongestRoRequest = 0;
 }
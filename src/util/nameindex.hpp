@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+/*
+ * Index of items by exact name and by wildcard pattern.
+ *
+ * Patterns are bucketed by literal prefix up to last '/' before first
+ * wildcard, so lookup touches only buckets for name and its parents.
+ * Found items are candidates, patterns still must be matched by caller.
+ */
+template <typename T>
+class TNameIndex {
+    typedef std::unordered_map<std::string, std::unordered_set<T>> TBuckets;
+
+    TBuckets Names;
+    TBuckets Patterns;
+
+    static std::string PatternKey(const std::string &pattern) {
+        auto prefix = pattern.substr(0, pattern.find_first_of("*?[\\"));
+        auto sep = prefix.rfind('/');
+        if (sep == std::string::npos)
+            return "";
+        return prefix.substr(0, sep + 1);
+    }
+
+    static void Erase(TBuckets &buckets, const std::string &key, T item) {
+        auto it = buckets.find(key);
+        if (it == buckets.end())
+            return;
+        it->second.erase(item);
+        if (it->second.empty())
+            buckets.erase(it);
+    }
+
+    static void Append(const TBuckets &buckets, const std::string &key, std::vector<T> &result) {
+        auto it = buckets.find(key);
+        if (it != buckets.end())
+            result.insert(result.end(), it->second.begin(), it->second.end());
+    }
+
+public:
+    void AddName(const std::string &name, T item) {
+        Names[name].insert(item);
+    }
+
+    void RemoveName(const std::string &name, T item) {
+        Erase(Names, name, item);
+    }
+
+    void AddPattern(const std::string &pattern, T item) {
+        Patterns[PatternKey(pattern)].insert(item);
+    }
+
+    void RemovePattern(const std::string &pattern, T item) {
+        Erase(Patterns, PatternKey(pattern), item);
+    }
+
+    /* Appends candidates in no particular order, item might be repeated */
+    void Find(const std::string &name, std::vector<T> &result) const {
+        Append(Names, name, result);
+
+        if (Patterns.empty())
+            return;
+
+        for (size_t pos = 0;;) {
+            Append(Patterns, name.substr(0, pos), result);
+            pos = name.find('/', pos);
+            if (pos == std::string::npos)
+                break;
+            pos++;
+        }
+    }
+};
@@ -700,38 +700,14 @@ TError TPath::Truncate(off_t size) const {
 }
 
 TError TPath::RotateLog(off_t max_disk_usage, off_t &loss) const {
-    struct stat st;
-    off_t hole_len;
+    TFile file;
     TError error;
 
-    int fd = open(c_str(), O_RDWR | O_CLOEXEC | O_NOCTTY);
-    if (fd < 0)
-        return TError::System("open(" + Path + ")");
-
-    if (fstat(fd, &st)) {
-        close(fd);
-        return TError::System("fstat(" + Path + ")");
-    }
-
-    if (!S_ISREG(st.st_mode) || (st.st_size <= max_disk_usage) || (st.st_size <= st.st_blksize)) {
-        loss = 0;
-        close(fd);
-        return OK;
-    }
-
-    /* Keep half of allowed size or trucate to zero */
-    hole_len = st.st_size - max_disk_usage / 2;
-    hole_len -= hole_len % st.st_blksize;
-    loss = hole_len;
-
-    if (fallocate(fd, FALLOC_FL_COLLAPSE_RANGE, 0, hole_len)) {
-        loss = st.st_size;
-        if (ftruncate(fd, 0))
-            error = TError::System("truncate(" + Path + ")");
-    }
+    error = file.Open(*this, O_RDWR | O_CLOEXEC | O_NOCTTY);
+    if (error)
+        return error;
 
-    close(fd);
-    return error;
+    return file.RotateLog(max_disk_usage, loss);
 }
 
 TError TPath::Chattr(unsigned add_flags, unsigned del_flags) const {
@@ -1441,6 +1417,32 @@ TError TFile::Truncate(off_t size) const {
     return OK;
 }
 
+TError TFile::RotateLog(off_t max_disk_usage, off_t &loss) const {
+    struct stat st;
+    off_t hole_len;
+
+    loss = 0;
+
+    if (fstat(Fd, &st))
+        return TError::System("fstat");
+
+    if (!S_ISREG(st.st_mode) || (st.st_size <= max_disk_usage) || (st.st_size <= st.st_blksize))
+        return OK;
+
+    /* Keep half of allowed size or trucate to zero */
+    hole_len = st.st_size - max_disk_usage / 2;
+    hole_len -= hole_len % st.st_blksize;
+    loss = hole_len;
+
+    if (fallocate(Fd, FALLOC_FL_COLLAPSE_RANGE, 0, hole_len)) {
+        loss = st.st_size;
+        if (ftruncate(Fd, 0))
+            return TError::System("ftruncate");
+    }
+
+    return OK;
+}
+
 TError TFile::WriteAll(const std::string &text) const {
     size_t len = text.length(), off = 0;
     do {
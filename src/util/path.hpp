@@ -295,6 +295,7 @@ public:
     TError ReadAll(std::string &text, size_t max) const;
     TError ReadEnds(std::string &text, size_t max) const;
     TError Truncate(off_t size) const;
+    TError RotateLog(off_t max_disk_usage, off_t &loss) const;
     TError WriteAll(const std::string &text) const;
     static TError Chattr(int fd, unsigned add_flags, unsigned del_flags);
     int GetMountId(const TPath &relative = "") const;
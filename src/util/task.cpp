@@ -5,13 +5,30 @@
 #include "unix.hpp"
 #include "log.hpp"
 #include "namespace.hpp"
+#include "proc.hpp"
+#include "string.hpp"
 
 extern "C" {
 #include <unistd.h>
+#include <signal.h>
+#include <string.h>
 #include <sys/wait.h>
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 }
 
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
 bool TTask::Exists() const {
     return Pid && (!kill(Pid, 0) || errno != ESRCH);
 }
@@ -25,6 +42,64 @@ TError TTask::Kill(int signal) const {
     return OK;
 }
 
+TError TTask::OpenPidfd(int &pidfd) const {
+    if (!Pid)
+        return TError("Task is not running");
+    pidfd = syscall(SYS_pidfd_open, Pid, 0);
+    if (pidfd < 0)
+        return TError::System("pidfd_open({})", Pid);
+    return OK;
+}
+
+TError TTask::GetExitStatus(int pidfd, int &status) const {
+    siginfo_t info;
+
+    /* Works only for own children */
+    info.si_pid = 0;
+    if (!waitid((idtype_t)P_PIDFD, pidfd, &info, WEXITED | WNOHANG | WNOWAIT)) {
+        if (!info.si_pid)
+            return TError(EError::Busy, "Task {} is not exited", Pid);
+        if (info.si_code == CLD_KILLED)
+            status = info.si_status;
+        else if (info.si_code == CLD_DUMPED)
+            status = info.si_status | (1 << 7);
+        else
+            status = info.si_status << 8;
+        return OK;
+    }
+
+    if (errno != ECHILD && errno != EINVAL)
+        return TError::System("waitid({})", Pid);
+
+    std::string stat;
+    TError error = GetProc(Pid, "stat", stat);
+    if (error)
+        return error;
+
+    const char *cleanStat = strrchr(stat.c_str(), ')');
+    if (!cleanStat)
+        return TError("Invalid /proc/pid/stat structure: {}", stat);
+
+    auto values = SplitEscapedString(cleanStat + 2, ' ');
+
+    // exit_code is at 50 position after command
+    if (values.size() < 50)
+        return TError("Invalid /proc/pid/stat structure: {}", stat);
+
+    if (values[0] != "Z")
+        return TError(EError::Busy, "Task {} is not exited", Pid);
+
+    error = StringToInt(values[49], status);
+    if (error)
+        return error;
+
+    /* Zombie still exists thus stat belongs to it */
+    if (syscall(SYS_pidfd_send_signal, pidfd, 0, nullptr, 0))
+        return TError::System("pidfd_send_signal({})", Pid);
+
+    return OK;
+}
+
 TError TTask::KillPg(int signal) const {
     if (!Pid)
         return TError("Task is not running");
@@ -20,6 +20,11 @@ struct TTask {
     pid_t GetPPid() const;
     TError Kill(int signal) const;
     TError KillPg(int signal) const;
+
+    /* Pidfd becomes readable when task exits, pid cannot be reused under it */
+    TError OpenPidfd(int &pidfd) const;
+    /* Status of exited task, zombie is left for its parent */
+    TError GetExitStatus(int pidfd, int &status) const;
 };
 
 void LocalTime(const time_t *time, struct tm &tm);
@@ -64,6 +64,40 @@ pid_t Clone(unsigned long flags, void *child_stack, void *ptid, void *ctid) {
     return syscall(SYS_clone, flags, child_stack, ptid, ctid);
 }
 
+#ifndef SYS_clone3
+#define SYS_clone3 435
+#endif
+
+#ifndef CLONE_INTO_CGROUP
+#define CLONE_INTO_CGROUP 0x200000000ULL
+#endif
+
+pid_t Clone3(uint64_t flags, int exitSignal, int cgroupFd) {
+    /* struct clone_args, CLONE_ARGS_SIZE_VER2 */
+    struct {
+        uint64_t flags;
+        uint64_t pidfd;
+        uint64_t child_tid;
+        uint64_t parent_tid;
+        uint64_t exit_signal;
+        uint64_t stack;
+        uint64_t stack_size;
+        uint64_t tls;
+        uint64_t set_tid;
+        uint64_t set_tid_size;
+        uint64_t cgroup;
+    } args = {};
+
+    args.flags = flags;
+    args.exit_signal = exitSignal;
+    if (cgroupFd >= 0) {
+        args.flags |= CLONE_INTO_CGROUP;
+        args.cgroup = cgroupFd;
+    }
+
+    return syscall(SYS_clone3, &args, sizeof(args));
+}
+
 pid_t Fork(bool ptrace) {
     return !ptrace ? fork() : Clone(CLONE_PTRACE | SIGCHLD);
 }
@@ -132,6 +166,12 @@ uint64_t GetCurrentTimeMs() {
     return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
+uint64_t GetCurrentTimeUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 bool WaitDeadline(uint64_t deadline, uint64_t wait) {
     uint64_t now = GetCurrentTimeMs();
     if (!deadline || int64_t(deadline - now) < 0)
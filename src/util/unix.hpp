@@ -26,6 +26,8 @@ pid_t GetPPid();
 pid_t GetTid();
 pid_t Clone(unsigned long flags, void *child_stack = NULL, void *ptid = NULL, void *ctid = NULL);
 pid_t Fork(bool ptrace = false);
+/* clone3() without stack, child is created right in cgroup if cgroupFd >= 0 */
+pid_t Clone3(uint64_t flags, int exitSignal, int cgroupFd = -1);
 inline pid_t PtracedVfork() __attribute__((always_inline));
 pid_t PtracedVfork() {
     pid_t pid = -1;
@@ -55,6 +57,7 @@ inline void PrintStack(pid_t pid, bool debug = true) {
 }
 
 uint64_t GetCurrentTimeMs();
+uint64_t GetCurrentTimeUs();
 bool WaitDeadline(uint64_t deadline, uint64_t sleep = 10);
 uint64_t GetTotalMemory();
 uint64_t GetHugetlbMemory();
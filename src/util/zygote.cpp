@@ -0,0 +1,264 @@
+#include "zygote.hpp"
+#include "task.hpp"
+#include "log.hpp"
+#include "signal.hpp"
+
+extern "C" {
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+}
+
+static constexpr int ZYGOTE_MAX_FDS = 16;
+static constexpr size_t ZYGOTE_MAX_REQUEST = 65536;
+static constexpr char ZYGOTE_MAGIC = 'Z';  /* request is never empty */
+static constexpr char ZYGOTE_MAGIC_LOG = 'L';  /* last fd is current log */
+
+TError TZygoteTask::Wait(bool interruptible,
+                         const std::atomic_bool &stop,
+                         const std::atomic_bool &disconnected) {
+    struct pollfd pfd = { Sock.GetFd(), POLLIN, 0 };
+    bool killed = false;
+    TError error;
+    int status;
+
+    while (true) {
+        int ret = poll(&pfd, 1, interruptible ? 100 : -1);
+        if (ret > 0)
+            break;
+        if (ret < 0 && errno != EINTR)
+            return TError::System("poll");
+
+        if (!killed && (stop || disconnected)) {
+            L_ACT("kill {} {}", SIGKILL, Pid);
+            if (kill(Pid, SIGKILL)) {
+                L_ERR("Cannot kill helper: {}", TError::System("kill"));
+            } else if (stop) {
+                L("Kill helper on portod reload");
+                error = TError(EError::SocketError, "Helper killed by timeout on portod reload");
+            } else
+                error = TError(EError::SocketError, "Helper killed at client disconnection");
+            killed = true;
+        }
+    }
+
+    TError error2 = Sock.RecvInt(status);
+    Sock.Close();
+    if (error2)
+        return TError(error2, "Cannot get status of zygote task {}", Pid);
+
+    Status = status;
+
+    if (error)
+        return error;
+
+    if (Status)
+        return TError(EError::Unknown, FormatExitStatus(Status));
+
+    return OK;
+}
+
+TError TZygote::Start(const THandler &handler) {
+    int sk[2];
+    TError error;
+    TTask task;
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sk))
+        return TError::System("socketpair");
+
+    error = task.Fork(true);
+    if (error) {
+        close(sk[0]);
+        close(sk[1]);
+        return error;
+    }
+
+    if (!task.Pid) {
+        close(sk[0]);
+        Sock = sk[1];
+        Loop(handler);
+    }
+
+    close(sk[1]);
+    Sock = sk[0];
+    Pid = task.Pid;
+
+    L_SYS("Zygote started pid {}", Pid);
+
+    return OK;
+}
+
+void TZygote::Stop() {
+    if (!Pid)
+        return;
+    Sock.Close();
+    (void)waitpid(Pid, nullptr, 0);
+    Pid = 0;
+}
+
+void TZygote::Loop(const THandler &handler) {
+    std::vector<char> buf(ZYGOTE_MAX_REQUEST);
+    char control[CMSG_SPACE(sizeof(int) * ZYGOTE_MAX_FDS)];
+
+    SetProcessName("portod-zygote");
+    SetDieOnParentExit(SIGKILL);
+    /* Keep stdio: received fds must not take their numbers */
+    TFile::CloseAllExcept({STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO,
+                           Sock.GetFd()});
+    /* Log is reopened by portod, tasks get current one with request */
+    if (LogFile.Fd > STDERR_FILENO)
+        LogFile.SetFd = -1;
+    ResetBlockedSignals();
+
+    /* Waiters are reaped automatically */
+    signal(SIGCHLD, SIG_IGN);
+
+    while (true) {
+        struct iovec iov = { buf.data(), buf.size() };
+        struct msghdr msg = {};
+        std::vector<std::string> args;
+        std::vector<int> fds;
+
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t len = recvmsg(Sock.GetFd(), &msg, MSG_CMSG_CLOEXEC);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            _exit(len ? EXIT_FAILURE : EXIT_SUCCESS);
+
+        for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            int *data = (int *)CMSG_DATA(cmsg);
+            for (size_t i = 0; i < (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int); i++)
+                fds.push_back(data[i]);
+        }
+
+        if (buf[0] != ZYGOTE_MAGIC && buf[0] != ZYGOTE_MAGIC_LOG)
+            len = 0;
+
+        for (ssize_t pos = 1; pos < len; ) {
+            args.emplace_back(buf.data() + pos);
+            pos += args.back().size() + 1;
+        }
+
+        if (len && fds.size() > (buf[0] == ZYGOTE_MAGIC_LOG ? 1u : 0u) &&
+                !(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)))
+            Serve(handler, args, fds, buf[0] == ZYGOTE_MAGIC_LOG);
+
+        for (auto fd: fds)
+            close(fd);
+    }
+}
+
+/* Forks waiter which forks task, reports its pid and exit status */
+void TZygote::Serve(const THandler &handler, std::vector<std::string> &args,
+                    std::vector<int> &fds, bool log) {
+    if (fork())
+        return;
+
+    signal(SIGCHLD, SIG_DFL);
+    SetDieOnParentExit(SIGKILL);
+    Sock.Close();
+
+    TUnixSocket reply(fds[0]);
+    fds.erase(fds.begin());
+
+    if (log) {
+        LogFile.SetFd = fds.back();
+        fds.pop_back();
+    }
+
+    pid_t pid = fork();
+    if (!pid) {
+        reply.Close();
+        handler(args, fds);
+        _exit(EXIT_FAILURE);
+    }
+
+    if (reply.SendInt(pid > 0 ? pid : 0) || pid < 0)
+        _exit(EXIT_FAILURE);
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            _exit(EXIT_FAILURE);
+    }
+
+    (void)reply.SendInt(status);
+    _exit(EXIT_SUCCESS);
+}
+
+TError TZygote::Spawn(const std::vector<std::string> &args,
+                      const std::vector<int> &fds,
+                      TZygoteTask &task) {
+    char control[CMSG_SPACE(sizeof(int) * ZYGOTE_MAX_FDS)] = {0};
+    TUnixSocket sk;
+    std::string payload;
+    TError error;
+    int pid;
+
+    if (!Pid)
+        return TError("Zygote is not running");
+
+    /* Reply socket, fds and log */
+    std::vector<int> sendFds(fds);
+    if (LogFile.Fd > STDERR_FILENO)
+        sendFds.push_back(LogFile.Fd);
+
+    if (sendFds.size() + 1 > ZYGOTE_MAX_FDS)
+        return TError(EError::InvalidValue, "Too many fds for zygote");
+
+    payload.push_back(sendFds.size() > fds.size() ? ZYGOTE_MAGIC_LOG : ZYGOTE_MAGIC);
+    for (auto &arg: args) {
+        payload += arg;
+        payload.push_back('\0');
+    }
+
+    if (payload.size() > ZYGOTE_MAX_REQUEST)
+        return TError(EError::InvalidValue, "Too long request for zygote");
+
+    error = TUnixSocket::SocketPair(task.Sock, sk);
+    if (error)
+        return error;
+
+    struct iovec iov = { &payload[0], payload.size() };
+    struct msghdr msg = {};
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * (sendFds.size() + 1));
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * (sendFds.size() + 1));
+
+    int *data = (int *)CMSG_DATA(cmsg);
+    data[0] = sk.GetFd();
+    for (size_t i = 0; i < sendFds.size(); i++)
+        data[i + 1] = sendFds[i];
+
+    if (sendmsg(Sock.GetFd(), &msg, MSG_NOSIGNAL) != (ssize_t)payload.size())
+        return TError::System("Cannot send request to zygote");
+
+    sk.Close();
+
+    error = task.Sock.RecvInt(pid);
+    if (error)
+        return TError(error, "Zygote did not report task pid");
+
+    if (!pid)
+        return TError("Zygote cannot fork task");
+
+    task.Pid = pid;
+
+    return OK;
+}
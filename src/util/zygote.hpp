@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "util/error.hpp"
+#include "util/unix.hpp"
+
+/*
+ * Task forked by zygote. Zygote keeps waiter process between them,
+ * waiter reports task pid and exit status into Sock.
+ */
+struct TZygoteTask {
+    pid_t Pid = 0;
+    int Status = 0;
+    TUnixSocket Sock;
+
+    TError Wait(bool interruptible = false,
+                const std::atomic_bool &stop = false,
+                const std::atomic_bool &disconnected = false);
+};
+
+/*
+ * Single-threaded helper forked while portod is still small.
+ * Forks tasks from its tiny address space rather than from portod.
+ * Serves only self-contained requests: RunCommand helpers. Container
+ * tasks are forked by portod, their setup needs its state.
+ */
+class TZygote {
+public:
+    /* Runs in forked task, must exec or _exit */
+    typedef std::function<void(const std::vector<std::string> &args,
+                               const std::vector<int> &fds)> THandler;
+
+private:
+    TUnixSocket Sock;
+    pid_t Pid = 0;
+
+    void Loop(const THandler &handler);
+    void Serve(const THandler &handler, std::vector<std::string> &args,
+               std::vector<int> &fds, bool log);
+
+public:
+    TError Start(const THandler &handler);
+    void Stop();
+
+    explicit operator bool() const { return Pid != 0; }
+
+    /* Passes args and fds into handler in forked task */
+    TError Spawn(const std::vector<std::string> &args,
+                 const std::vector<int> &fds,
+                 TZygoteTask &task);
+};
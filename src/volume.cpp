@@ -3020,6 +3020,8 @@ TError TVolume::DestroyOne() {
 
     TPath node(VolumesKV / Id);
     auto volumes_lock = LockVolumes();
+    if (KvStorage)
+        KvStorage->Drop();
     error = node.Unlink();
     volumes_lock.unlock();
     if (!ret && error)
@@ -3129,7 +3131,7 @@ out:
     volumes_lock.unlock();
 
     if (!error)
-        Save();
+        Save(false, false);
 
     return error;
 }
@@ -3476,7 +3478,7 @@ void TVolume::UpdateStatFS() {
     StatFS(Stat);
 }
 
-TError TVolume::Save(bool locked) {
+TError TVolume::Save(bool locked, bool sync) {
     TKeyValue node(VolumesKV / Id);
     TError error;
     std::string tmp;
@@ -3549,7 +3551,7 @@ TError TVolume::Save(bool locked) {
 
     node.Set(V_PLACE, Place.ToString());
 
-    error = node.Save();
+    error = KvStorage->Save(node.Data, sync);
     if (error)
         L_WRN("Cannot save volume {} {}", Path, error);
 
@@ -3571,6 +3573,8 @@ TError TVolume::Restore(const TKeyValue &node) {
     if (error)
         return error;
 
+    KvStorage = std::make_shared<TKeyValueStorage>(VolumesKV / Id);
+
     if (!spec.has_place())
         Place = PORTO_PLACE;
 
@@ -3775,6 +3779,7 @@ TError TVolume::Create(const rpc::TVolumeSpec &spec,
 
     volume = std::make_shared<TVolume>();
     volume->Id = std::to_string(NextId++);
+    volume->KvStorage = std::make_shared<TKeyValueStorage>(VolumesKV / volume->Id);
     volume->Spec = &spec;
 
     /* Default user:group */
@@ -57,6 +57,7 @@ constexpr const char *V_DEVICE_NAME = "device_name";
 class TVolume;
 class TContainer;
 class TKeyValue;
+class TKeyValueStorage;
 
 enum class EVolumeState {
     Initial,
@@ -114,6 +115,7 @@ public:
     bool IsAutoPath = false;
     uint64_t BuildTime = 0;
     uint64_t ChangeTime = 0;
+    std::shared_ptr<TKeyValueStorage> KvStorage; /* created together with Id */
 
     TStatFS Stat;
 
@@ -210,7 +212,7 @@ public:
     TError DestroyOne();
     TError Destroy();
 
-    TError Save(bool locked = false);
+    TError Save(bool locked = false, bool sync = true);
     TError Restore(const TKeyValue &node);
 
     static void RestoreAll(void);
@@ -1,14 +1,34 @@
 #include "waiter.hpp"
 #include "client.hpp"
+#include "util/nameindex.hpp"
 #include <time.h>
 
 static std::mutex ContainerWaitersLock;
-static std::list<TContainerWaiter *> ContainerWaiters;
+static uint64_t ContainerWaitersSeq = 0;
+
+/* All active waiters and waiters which are interested in labels */
+static TNameIndex<TContainerWaiter *> ContainerWaiters;
+static TNameIndex<TContainerWaiter *> LabelWaiters;
 
 static inline std::unique_lock<std::mutex> LockWaiters() {
     return std::unique_lock<std::mutex>(ContainerWaitersLock);
 }
 
+static void IndexWaiter(TNameIndex<TContainerWaiter *> &index, TContainerWaiter *waiter, bool add) {
+    for (auto &name: waiter->Names) {
+        if (add)
+            index.AddName(name, waiter);
+        else
+            index.RemoveName(name, waiter);
+    }
+    for (auto &wildcard: waiter->Wildcards) {
+        if (add)
+            index.AddPattern(wildcard, waiter);
+        else
+            index.RemovePattern(wildcard, waiter);
+    }
+}
+
 TContainerWaiter::~TContainerWaiter() {
     if (Active) {
         auto lock = LockWaiters();
@@ -27,13 +47,20 @@ void TContainerWaiter::Activate(std::shared_ptr<TClient> &client) {
     if (!Names.empty() || !Wildcards.empty()) {
         *link = shared_from_this();
         Active = true;
-        ContainerWaiters.push_back(this);
+        Seq = ++ContainerWaitersSeq;
+        IndexWaiter(ContainerWaiters, this, true);
+        if (!Labels.empty())
+            IndexWaiter(LabelWaiters, this, true);
     }
 }
 
 void TContainerWaiter::Deactivate() {
-    Active = false;
-    ContainerWaiters.remove(this);
+    if (Active) {
+        Active = false;
+        IndexWaiter(ContainerWaiters, this, false);
+        if (!Labels.empty())
+            IndexWaiter(LabelWaiters, this, false);
+    }
 }
 
 bool TContainerWaiter::ShouldReport(TContainer &ct) {
@@ -67,33 +94,38 @@ bool TContainerWaiter::ShouldReportLabel(const std::string &label) {
 }
 
 void TContainerWaiter::ReportAll(TContainer &ct, const std::string &label, const std::string &value) {
+    /* Labels starting with lowercase are state details, reported to everybody */
+    bool labelOnly = !label.empty() && !(label[0] >= 'a' && label[0] <= 'z');
+    std::vector<TContainerWaiter *> waiters;
+
     auto lock = LockWaiters();
-    for (auto it = ContainerWaiters.begin(); it != ContainerWaiters.end();) {
-        auto waiter = *it;
-        if (waiter->ShouldReport(ct) &&
-                (label.empty() || (label[0] >= 'a' && label[0] <= 'z') ||
-                 waiter->ShouldReportLabel(label))) {
-            auto client = waiter->Client.lock();
-
-            std::string name;
-            if (client && !client->ComposeName(ct.Name, name)) {
-                client->MakeReport(name, TContainer::StateName(ct.State), waiter->Async, label, value);
-
-                if (!waiter->Async || !waiter->TargetState.empty()) {
-                    ++it;
-                    waiter->Deactivate();
-                    if (waiter->Async)
-                        client->AsyncWaiter.reset();
-                    else
-                        client->SyncWaiter.reset();
-                    continue;
-                }
+
+    (labelOnly ? LabelWaiters : ContainerWaiters).Find(ct.Name, waiters);
+
+    std::sort(waiters.begin(), waiters.end(),
+              [](const TContainerWaiter *a, const TContainerWaiter *b) {
+                  return a->Seq < b->Seq;
+              });
+    waiters.erase(std::unique(waiters.begin(), waiters.end()), waiters.end());
+
+    for (auto waiter: waiters) {
+        if (!waiter->ShouldReport(ct) || (labelOnly && !waiter->ShouldReportLabel(label)))
+            continue;
+
+        auto client = waiter->Client.lock();
+
+        std::string name;
+        if (client && !client->ComposeName(ct.Name, name)) {
+            client->MakeReport(name, TContainer::StateName(ct.State), waiter->Async, label, value);
+
+            if (!waiter->Async || !waiter->TargetState.empty()) {
+                waiter->Deactivate();
+                if (waiter->Async)
+                    client->AsyncWaiter.reset();
+                else
+                    client->SyncWaiter.reset();
             }
         }
-        if (waiter->Active)
-            ++it;
-        else
-            it = ContainerWaiters.erase(it);
     }
 }
 
@@ -127,12 +159,14 @@ bool TContainerWaiter::operator==(const TContainerWaiter &waiter) const {
 
 TError TContainerWaiter::Remove(const TContainerWaiter &waiter, const TClient &client) {
     auto lock = LockWaiters();
-    for (auto it = ContainerWaiters.begin(); it != ContainerWaiters.end(); ++it) {
-        auto otherWaiter = *it;
+
+    /* Active waiters are always linked to their clients */
+    auto otherWaiter = waiter.Async ? client.AsyncWaiter : client.SyncWaiter;
+    if (otherWaiter && otherWaiter->Active && waiter == *otherWaiter) {
         auto waiterClient = otherWaiter->Client.lock();
 
         // client of waiter is nullptr
-        if (&client == waiterClient.get() && waiter == *otherWaiter) {
+        if (&client == waiterClient.get()) {
             otherWaiter->Deactivate();
             if (waiter.Async)
                 waiterClient->AsyncWaiter.reset();
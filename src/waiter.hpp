@@ -28,6 +28,7 @@ public:
     std::string TargetState;
     bool Async;
     bool Active = false;
+    uint64_t Seq = 0;   /* activation order, reports are sent in this order */
 
     TContainerWaiter(bool async) : Async(async) { }
     ~TContainerWaiter();
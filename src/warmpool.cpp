@@ -0,0 +1,334 @@
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <list>
+#include <map>
+#include "warmpool.hpp"
+#include "volume.hpp"
+#include "container.hpp"
+#include "network.hpp"
+#include "client.hpp"
+#include "config.hpp"
+#include "util/log.hpp"
+#include "util/string.hpp"
+#include "util/unix.hpp"
+#include "util/thread.hpp"
+#include <cstring>
+#include <unistd.h>
+
+/* Private value of idle volumes, suffixed with template name */
+constexpr const char *WARM_PRIVATE = "porto-warm:";
+
+/* Private value of claimed volumes until pool releases them */
+constexpr const char *WARM_CLAIMED = "porto-warm-claimed";
+
+struct TWarmInstance {
+    std::shared_ptr<TVolume> Volume;
+    int Netns = -1;
+};
+
+static std::mutex WarmMutex;
+static std::condition_variable WarmCv;
+static std::map<std::string, std::list<TWarmInstance>> WarmIdle;
+static std::list<std::shared_ptr<TVolume>> WarmRelease;
+static std::unique_ptr<std::thread> WarmThread;
+static bool WarmStopping = false;
+
+static const cfg::TConfig::TContainerCfg::TWarmTemplate *FindTemplate(const std::string &name) {
+    for (auto &tmpl: config().container().warm_template())
+        if (tmpl.name() == name)
+            return &tmpl;
+    return nullptr;
+}
+
+bool TWarmPool::HasTemplate(const std::string &name) {
+    return FindTemplate(name) != nullptr;
+}
+
+TError TWarmPool::BuildSpec(const std::string &name, rpc::TVolumeSpec &spec) {
+    auto tmpl = FindTemplate(name);
+    if (!tmpl)
+        return TError(EError::InvalidValue, "Unknown warm template {}", name);
+
+    if (tmpl->has_backend())
+        spec.set_backend(tmpl->backend());
+    if (tmpl->has_place())
+        spec.set_place(tmpl->place());
+    if (tmpl->has_space_limit())
+        spec.mutable_space()->set_limit(tmpl->space_limit());
+    for (auto &layer: tmpl->layers())
+        spec.add_layers(layer);
+
+    return OK;
+}
+
+static TError BuildInstance(const cfg::TConfig::TContainerCfg::TWarmTemplate &tmpl,
+                            TWarmInstance &inst) {
+    rpc::TVolumeSpec spec;
+    TError error;
+
+    error = TWarmPool::BuildSpec(tmpl.name(), spec);
+    if (error)
+        return error;
+
+    /* Linked to root until claimed */
+    spec.set_private_value(WARM_PRIVATE + tmpl.name());
+
+    error = TVolume::Create(spec, inst.Volume);
+    if (error)
+        return error;
+
+    if (tmpl.net_isolate()) {
+        error = TNetwork::NewNetns(inst.Netns);
+        if (error) {
+            L_WRN("Cannot create netns for warm template {}: {}", tmpl.name(), error);
+            inst.Netns = -1;
+        }
+    }
+
+    return OK;
+}
+
+/* Drops root link of claimed or stale volume, unused volume is destroyed */
+static void ReleaseVolume(std::shared_ptr<TVolume> volume) {
+    std::list<std::shared_ptr<TVolume>> unlinked;
+    TError error;
+
+    error = CL->LockContainer(RootContainer);
+    if (!error) {
+        error = volume->UnlinkVolume(RootContainer, "", unlinked);
+        CL->ReleaseContainer();
+    }
+    if (error && error != EError::VolumeNotLinked)
+        L_WRN("Cannot release warm volume {}: {}", volume->Path, error);
+
+    auto volumes_lock = LockVolumes();
+    if (volume->Private == WARM_CLAIMED && volume->State == EVolumeState::Ready) {
+        volume->Private.clear();
+        error = volume->Save(true);
+        if (error)
+            L_WRN("Cannot save volume {}: {}", volume->Path, error);
+    }
+    volumes_lock.unlock();
+
+    TVolume::DestroyUnlinked(unlinked);
+}
+
+/* Adopt volumes left by previous instance, network namespaces are lost */
+static void AdoptVolumes() {
+    auto volumes_lock = LockVolumes();
+
+    for (auto &it: Volumes) {
+        auto &volume = it.second;
+
+        if (volume->State != EVolumeState::Ready)
+            continue;
+
+        if (volume->Private == WARM_CLAIMED) {
+            WarmRelease.push_back(volume);
+            continue;
+        }
+
+        if (!StringStartsWith(volume->Private, WARM_PRIVATE))
+            continue;
+
+        std::string name = volume->Private.substr(strlen(WARM_PRIVATE));
+        auto tmpl = FindTemplate(name);
+
+        if (tmpl && volume->Links.size() == 1 &&
+                volume->Links.front()->Container == RootContainer &&
+                WarmIdle[name].size() < tmpl->size()) {
+            TWarmInstance inst;
+            inst.Volume = volume;
+            WarmIdle[name].push_back(inst);
+            Statistics->WarmPoolIdle++;
+        } else if (volume->VolumeOwnerContainer == RootContainer)
+            WarmRelease.push_back(volume);
+    }
+}
+
+/* Idle instances above template size or of removed template are released */
+static void TrimIdle() {
+    for (auto it = WarmIdle.begin(); it != WarmIdle.end(); ) {
+        auto tmpl = FindTemplate(it->first);
+        auto &idle = it->second;
+
+        while (idle.size() > (tmpl ? tmpl->size() : 0)) {
+            auto &inst = idle.back();
+            if (inst.Netns >= 0)
+                close(inst.Netns);
+            WarmRelease.push_back(inst.Volume);
+            idle.pop_back();
+            Statistics->WarmPoolIdle--;
+        }
+
+        if (idle.empty() && !tmpl)
+            it = WarmIdle.erase(it);
+        else
+            ++it;
+    }
+}
+
+static void WarmLoop() {
+    TClient client("<warm>");
+
+    SetProcessName("portod-warm");
+
+    client.ClientContainer = RootContainer;
+    client.StartRequest();
+
+    auto lock = std::unique_lock<std::mutex>(WarmMutex);
+
+    while (!WarmStopping) {
+        TrimIdle();
+
+        while (!WarmRelease.empty() && !WarmStopping) {
+            auto volume = WarmRelease.front();
+            WarmRelease.pop_front();
+            lock.unlock();
+            ReleaseVolume(volume);
+            lock.lock();
+        }
+
+        for (auto &tmpl: config().container().warm_template()) {
+            auto &idle = WarmIdle[tmpl.name()];
+
+            while (idle.size() < tmpl.size() && WarmRelease.empty() && !WarmStopping) {
+                TWarmInstance inst;
+
+                lock.unlock();
+                TError error = BuildInstance(tmpl, inst);
+                lock.lock();
+
+                if (error) {
+                    L_WRN("Cannot refill warm template {}: {}", tmpl.name(), error);
+                    break;
+                }
+
+                L_ACT("Warm volume {} for template {}", inst.Volume->Path, tmpl.name());
+                idle.push_back(inst);
+                Statistics->WarmPoolIdle++;
+            }
+        }
+
+        WarmCv.wait_for(lock, std::chrono::seconds(1));
+    }
+
+    /* Idle volumes stay linked to root and will be adopted after restart */
+    for (auto &it: WarmIdle) {
+        for (auto &inst: it.second)
+            if (inst.Netns >= 0)
+                close(inst.Netns);
+        Statistics->WarmPoolIdle -= it.second.size();
+    }
+    WarmIdle.clear();
+
+    lock.unlock();
+
+    client.FinishRequest();
+}
+
+void TWarmPool::Start() {
+    WarmStopping = false;
+    Statistics->WarmPoolIdle = 0;
+
+    AdoptVolumes();
+
+    /* Without templates pool thread only releases stale volumes */
+    if (!config().container().warm_template_size() && WarmRelease.empty())
+        return;
+
+    WarmThread = std::unique_ptr<std::thread>(NewThread(&WarmLoop));
+}
+
+void TWarmPool::Stop() {
+    if (!WarmThread)
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(WarmMutex);
+    WarmStopping = true;
+    WarmCv.notify_all();
+    lock.unlock();
+
+    WarmThread->join();
+    WarmThread = nullptr;
+}
+
+bool TWarmPool::Claim(std::shared_ptr<TContainer> ct, std::shared_ptr<TVolume> &volume) {
+    auto lock = std::unique_lock<std::mutex>(WarmMutex);
+    auto it = WarmIdle.find(ct->WarmTemplate);
+
+    if (!WarmThread || it == WarmIdle.end() || it->second.empty()) {
+        Statistics->WarmPoolMissed++;
+        return false;
+    }
+
+    TWarmInstance inst = it->second.front();
+    it->second.pop_front();
+    Statistics->WarmPoolIdle--;
+    lock.unlock();
+
+    TError error = inst.Volume->LinkVolume(ct);
+    if (!error) {
+        auto volumes_lock = LockVolumes();
+        if (inst.Volume->VolumeOwnerContainer)
+            inst.Volume->VolumeOwnerContainer->OwnedVolumes.remove(inst.Volume);
+        inst.Volume->VolumeOwnerContainer = ct;
+        ct->OwnedVolumes.push_back(inst.Volume);
+        inst.Volume->VolumeOwner = ct->OwnerCred;
+        inst.Volume->Private = WARM_CLAIMED;
+        TError error2 = inst.Volume->Save(true);
+        if (error2)
+            L_WRN("Cannot save volume {}: {}", inst.Volume->Path, error2);
+    }
+
+    /* Root link is dropped by pool thread, unclaimed volume is destroyed */
+    lock.lock();
+    WarmRelease.push_back(inst.Volume);
+    WarmCv.notify_all();
+    lock.unlock();
+
+    if (error) {
+        L_WRN("Cannot claim warm volume {} for CT{}:{}: {}",
+              inst.Volume->Path, ct->Id, ct->Name, error);
+        if (inst.Netns >= 0)
+            close(inst.Netns);
+        Statistics->WarmPoolMissed++;
+        return false;
+    }
+
+    ct->WarmNetns.Close();
+    ct->WarmNetns.SetFd = inst.Netns;
+
+    Statistics->WarmPoolClaimed++;
+    volume = inst.Volume;
+    return true;
+}
+
+void TWarmPool::Release(std::shared_ptr<TContainer> ct) {
+    std::list<std::shared_ptr<TVolume>> unlinked;
+    std::shared_ptr<TVolume> volume;
+    TError error;
+
+    if (!ct->WarmRoot)
+        return;
+
+    auto volumes_lock = LockVolumes();
+    auto it = Volumes.find(ct->WarmRoot);
+    if (it != Volumes.end())
+        volume = it->second;
+    volumes_lock.unlock();
+
+    if (volume) {
+        error = volume->UnlinkVolume(ct, "", unlinked);
+        if (error && error != EError::VolumeNotLinked)
+            L_WRN("Cannot unlink warm root {}: {}", ct->WarmRoot, error);
+    }
+
+    L("Release warm root {} of CT{}:{}", ct->WarmRoot, ct->Id, ct->Name);
+    ct->LockStateWrite();
+    ct->SetWarmRoot(TPath());
+    ct->UnlockState();
+
+    TVolume::DestroyUnlinked(unlinked);
+}
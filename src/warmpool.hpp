@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "common.hpp"
+
+class TContainer;
+class TVolume;
+
+namespace rpc {
+    class TVolumeSpec;
+}
+
+/*
+ * Pool of pre-built root volumes and network namespaces per warm template
+ * from config container.warm_template, claimed by property warm_template.
+ */
+class TWarmPool {
+public:
+    static void Start();
+    static void Stop();
+
+    static bool HasTemplate(const std::string &name);
+    static TError BuildSpec(const std::string &name, rpc::TVolumeSpec &spec);
+
+    /* Links idle volume to locked container and hands over ownership */
+    static bool Claim(std::shared_ptr<TContainer> ct, std::shared_ptr<TVolume> &volume);
+
+    /* Unlinks and destroys warm root of locked container */
+    static void Release(std::shared_ptr<TContainer> ct);
+};
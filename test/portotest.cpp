@@ -38,9 +38,90 @@ static int Stresstest(int argc, char *argv[]) {
     return test::StressTest(threads, iter, killPorto);
 }
 
+static int Stressbench(int argc, char *argv[]) {
+    int threads = 16, iter = 100;
+    if (argc >= 1)
+        StringToInt(argv[0], threads);
+    if (argc >= 2)
+        StringToInt(argv[1], iter);
+    std::cout << "Threads: " << threads << " Iterations: " << iter << std::endl;
+    return test::StressBench(threads, iter);
+}
+
+static int Registrybench(int argc, char *argv[]) {
+    int count = 10000, iter = 100;
+    if (argc >= 1)
+        StringToInt(argv[0], count);
+    if (argc >= 2)
+        StringToInt(argv[1], iter);
+    return test::RegistryBench(count, iter);
+}
+
+static int Waiterbench(int argc, char *argv[]) {
+    int count = 10000, changes = 6000;
+    if (argc >= 1)
+        StringToInt(argv[0], count);
+    if (argc >= 2)
+        StringToInt(argv[1], changes);
+    return test::WaiterBench(count, changes);
+}
+
+static int Zygotebench(int argc, char *argv[]) {
+    int spawns = 1000, rssMb = 1024;
+    if (argc >= 1)
+        StringToInt(argv[0], spawns);
+    if (argc >= 2)
+        StringToInt(argv[1], rssMb);
+    return test::ZygoteBench(spawns, rssMb);
+}
+
+static int Clonebench(int argc, char *argv[]) {
+    int spawns = 1000;
+    std::string cgroup2 = "/sys/fs/cgroup/unified";
+    if (argc >= 1)
+        StringToInt(argv[0], spawns);
+    if (argc >= 2)
+        cgroup2 = argv[1];
+    return test::CloneBench(spawns, cgroup2);
+}
+
+static int Killbench(int argc, char *argv[]) {
+    int threads = 20000;
+    std::string cgroup2 = "/sys/fs/cgroup/unified";
+    if (argc >= 1)
+        StringToInt(argv[0], threads);
+    if (argc >= 2)
+        cgroup2 = argv[1];
+    return test::KillBench(threads, cgroup2);
+}
+
+static int Netnsbench(int argc, char *argv[]) {
+    int count = 1000;
+    if (argc >= 1)
+        StringToInt(argv[0], count);
+    return test::NetnsBench(count);
+}
+
+static int Warmstartbench(int argc, char *argv[]) {
+    int count = 10;
+    if (argc < 1)
+        return EXIT_FAILURE;
+    if (argc >= 2)
+        StringToInt(argv[1], count);
+    return test::WarmStartBench(argv[0], count);
+}
+
 static void Usage() {
     std::cout << "usage: " << program_invocation_short_name << " [--except] <selftest>..." << std::endl;
     std::cout << "       " << program_invocation_short_name << " stress [threads] [iterations] [kill=on/off]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " bench [threads] [iterations]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " registry [containers] [iterations]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " waiters [waiters] [changes]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " zygote [spawns] [rss_mb]    (helper spawns, not container start)" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " clone3 [spawns] [cgroup2]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " killall [threads] [cgroup2]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " netns [count]" << std::endl;
+    std::cout << "       " << program_invocation_short_name << " warmstart <template> [count]" << std::endl;
 }
 
 static int TestConnectivity() {
@@ -62,6 +143,27 @@ int main(int argc, char *argv[]) {
     if (argc == 2 && !strcmp(argv[1], "connectivity"))
         return TestConnectivity();
 
+    if (argc >= 2 && !strcmp(argv[1], "registry"))
+        return Registrybench(argc - 2, argv + 2);
+
+    if (argc >= 2 && !strcmp(argv[1], "waiters"))
+        return Waiterbench(argc - 2, argv + 2);
+
+    if (argc >= 2 && !strcmp(argv[1], "zygote"))
+        return Zygotebench(argc - 2, argv + 2);
+
+    if (argc >= 2 && !strcmp(argv[1], "clone3"))
+        return Clonebench(argc - 2, argv + 2);
+
+    if (argc >= 2 && !strcmp(argv[1], "killall"))
+        return Killbench(argc - 2, argv + 2);
+
+    if (argc >= 2 && !strcmp(argv[1], "netns"))
+        return Netnsbench(argc - 2, argv + 2);
+
+    if (argc >= 2 && !strcmp(argv[1], "warmstart"))
+        return Warmstartbench(argc - 2, argv + 2);
+
     // in case client closes pipe we are writing to in the protobuf code
     Signal(SIGPIPE, SIG_IGN);
 
@@ -95,5 +197,8 @@ int main(int argc, char *argv[]) {
     if (what == "stress")
         return Stresstest(argc - 2, argv + 2);
 
+    if (what == "bench")
+        return Stressbench(argc - 2, argv + 2);
+
     return Selftest(argc - 1, argv + 1);
 }
@@ -1,18 +1,31 @@
 #include <iostream>
 #include <thread>
+#include <chrono>
 #include <atomic>
 #include <csignal>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <cstring>
+#include <random>
 #include <algorithm>
 
 #include "config.hpp"
 #include "util/string.hpp"
+#include "util/unix.hpp"
+#include "util/nameindex.hpp"
+#include "util/zygote.hpp"
 #include "test.hpp"
 
 extern "C" {
 #include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <pthread.h>
 }
 
 namespace test {
@@ -250,6 +263,603 @@ static void StressKill() {
     }
 }
 
+static void BenchTask(int n, int iter, std::atomic<uint64_t> &ops) {
+    Porto::Connection api;
+    std::string meta = "stressbench" + std::to_string(n);
+
+    tid = n;
+
+    /* Each thread works in its own first level subtree */
+    ExpectApiSuccess(api.Create(meta));
+    for (int i = 0; i < iter; i++) {
+        std::string name = meta + "/ct" + std::to_string(i);
+        ExpectApiSuccess(api.Create(name));
+        ExpectApiSuccess(api.SetProperty(name, "command", "true"));
+        ExpectApiSuccess(api.Start(name));
+        ExpectApiSuccess(api.Destroy(name));
+        ops++;
+    }
+    ExpectApiSuccess(api.Destroy(meta));
+}
+
+int StressBench(int threads, int iter) {
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    ReadConfigs();
+    Porto::Connection api;
+
+    std::cout << "RW threads: " << config().daemon().rw_threads() << std::endl;
+
+    for (int nr = 1; nr <= threads; nr *= 2) {
+        std::vector<std::thread> thrTasks;
+        std::atomic<uint64_t> ops(0);
+        uint64_t start = GetCurrentTimeMs();
+
+        for (int i = 1; i <= nr; i++)
+            thrTasks.push_back(std::thread(BenchTask, i, iter, std::ref(ops)));
+        for (auto &th : thrTasks)
+            th.join();
+
+        uint64_t ms = std::max(GetCurrentTimeMs() - start, (uint64_t)1);
+        std::cout << "Clients: " << nr << " create/start/destroy: " << ops
+                  << " time: " << ms << " ms rate: " << ops * 1000 / ms << "/s" << std::endl;
+    }
+
+    TestDaemon(api);
+
+    std::cout << "Bench completed!" << std::endl;
+
+    return 0;
+}
+
+static std::atomic<uint64_t> RegistryBytes(0);
+
+template <typename T>
+struct TRegistryAllocator : public std::allocator<T> {
+    template <typename U> struct rebind { typedef TRegistryAllocator<U> other; };
+
+    TRegistryAllocator() = default;
+    template <typename U> TRegistryAllocator(const TRegistryAllocator<U> &) {}
+
+    T *allocate(size_t n) {
+        RegistryBytes += n * sizeof(T);
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        RegistryBytes -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+template <typename Index>
+static void RegistryLookup(const char *title, const std::vector<std::string> &names, int iter) {
+    typedef typename Index::value_type value_type;
+    uint64_t bytes = RegistryBytes;
+    uint64_t found = 0;
+    Index index;
+
+    for (size_t i = 0; i < names.size(); i++)
+        index.insert(value_type(names[i], i + 1));
+    bytes = RegistryBytes - bytes;
+
+    /* lookup by copies, like names parsed from requests */
+    std::vector<std::string> keys(names.begin(), names.end());
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    uint64_t start = GetCurrentTimeMs();
+    for (int i = 0; i < iter; i++)
+        for (auto &key: keys)
+            found += index.find(key) != index.end();
+    uint64_t ms = std::max(GetCurrentTimeMs() - start, (uint64_t)1);
+
+    ExpectEq(found, keys.size() * iter);
+    std::cout << title << ": lookups: " << found << " time: " << ms << " ms "
+              << ms * 1000000 / found << " ns/lookup index: " << bytes / 1024 << " KiB" << std::endl;
+}
+
+int RegistryBench(int count, int iter) {
+    std::vector<std::string> names;
+
+    /* slot/pod/box/workload hierarchy with long common prefixes */
+    for (int i = 0; names.size() < (size_t)count; i++) {
+        std::string slot = "ISS-AGENT--" + std::to_string(1000000 + i) + "_production_service";
+        names.push_back(slot);
+        for (int j = 0; j < 4 && names.size() < (size_t)count; j++) {
+            std::string pod = slot + "/pod_" + std::to_string(j);
+            names.push_back(pod);
+            for (int k = 0; k < 8 && names.size() < (size_t)count; k++)
+                names.push_back(pod + "/box_" + std::to_string(k) + "/workload");
+        }
+    }
+
+    std::cout << "Containers: " << names.size() << " Iterations: " << iter << std::endl;
+
+    RegistryLookup<std::map<std::string, uint64_t, std::less<std::string>,
+        TRegistryAllocator<std::pair<const std::string, uint64_t>>>>("map", names, iter);
+
+    RegistryLookup<std::unordered_map<std::string, uint64_t, std::hash<std::string>,
+        std::equal_to<std::string>, TRegistryAllocator<std::pair<const std::string, uint64_t>>>>(
+            "unordered_map", names, iter);
+
+    return 0;
+}
+
+struct TBenchWaiter {
+    std::vector<std::string> Names;
+    std::vector<std::string> Wildcards;
+    std::vector<std::string> Labels;
+    uint64_t Seq;
+
+    /* Same checks as TContainerWaiter::ShouldReport/ShouldReportLabel */
+    bool Match(const std::string &name, const std::string &label) const {
+        bool found = false;
+        for (auto &nm: Names)
+            found = found || name == nm;
+        for (auto &wc: Wildcards)
+            found = found || StringMatch(name, wc);
+        if (!found || label.empty())
+            return found;
+        for (auto &wc: Labels)
+            if (StringMatch(label, wc))
+                return true;
+        return false;
+    }
+};
+
+static uint64_t BenchTimeUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void WaiterReportTime(const char *title, uint64_t reports, uint64_t us, int changes) {
+    std::cout << title << ": reports: " << reports << " time: " << us / 1000 << " ms "
+              << us * 1000 / changes << " ns/change, at 100 changes/s: "
+              << us * 100 / changes << " us/s" << std::endl;
+}
+
+int WaiterBench(int count, int changes) {
+    std::vector<std::string> names;
+    std::vector<TBenchWaiter> waiters(count);
+    std::mt19937 rnd(42);
+
+    for (int i = 0; names.size() < (size_t)count; i++) {
+        std::string slot = "ISS-AGENT--" + std::to_string(1000000 + i);
+        names.push_back(slot);
+        for (int j = 0; j < 4; j++)
+            names.push_back(slot + "/box_" + std::to_string(j));
+    }
+
+    /* agents watch own containers, subtrees and labels, few watch everything */
+    for (int i = 0; i < count; i++) {
+        auto &waiter = waiters[i];
+        auto &slot = names[rnd() % names.size()];
+        waiter.Seq = i;
+        if (i % 1000 == 0)
+            waiter.Wildcards.push_back("***");
+        else if (i % 3 == 0)
+            waiter.Wildcards.push_back(slot.substr(0, slot.find('/')) + "/*");
+        else
+            waiter.Names.push_back(slot);
+        if (i % 20 == 0)
+            waiter.Labels.push_back("AGENT.*");
+    }
+
+    TNameIndex<TBenchWaiter *> index, labelIndex;
+    for (auto &waiter: waiters) {
+        for (auto idx: {&index, &labelIndex}) {
+            if (idx == &labelIndex && waiter.Labels.empty())
+                continue;
+            for (auto &name: waiter.Names)
+                idx->AddName(name, &waiter);
+            for (auto &wildcard: waiter.Wildcards)
+                idx->AddPattern(wildcard, &waiter);
+        }
+    }
+
+    /* state changes interleaved with label changes */
+    std::vector<std::pair<std::string, std::string>> reports;
+    for (int i = 0; i < changes; i++)
+        reports.emplace_back(names[rnd() % names.size()], i % 4 == 3 ? "AGENT.state" : "");
+
+    std::cout << "Waiters: " << count << " Containers: " << names.size()
+              << " Changes: " << changes << std::endl;
+
+    uint64_t listFound = 0;
+    uint64_t start = BenchTimeUs();
+    for (auto &report: reports)
+        for (auto &waiter: waiters)
+            listFound += waiter.Match(report.first, report.second);
+    uint64_t listUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    uint64_t indexFound = 0;
+    std::vector<TBenchWaiter *> found;
+    start = BenchTimeUs();
+    for (auto &report: reports) {
+        found.clear();
+        (report.second.empty() ? index : labelIndex).Find(report.first, found);
+        std::sort(found.begin(), found.end(), [](const TBenchWaiter *a, const TBenchWaiter *b) {
+            return a->Seq < b->Seq;
+        });
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        for (auto waiter: found)
+            indexFound += waiter->Match(report.first, report.second);
+    }
+    uint64_t indexUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    ExpectEq(listFound, indexFound);
+
+    WaiterReportTime("list", listFound, listUs, changes);
+    WaiterReportTime("index", indexFound, indexUs, changes);
+
+    return 0;
+}
+
+static void SpawnReportTime(const char *title, uint64_t us, int spawns) {
+    std::cout << title << ": time: " << us / 1000 << " ms "
+              << us / spawns << " us/spawn "
+              << (uint64_t)spawns * 1000000 / us << " spawns/s" << std::endl;
+}
+
+/* Helper spawn only, container tasks are still forked by portod */
+int ZygoteBench(int spawns, int rssMb) {
+    TZygote zygote;
+
+    ExpectOk(zygote.Start([](const std::vector<std::string> &, const std::vector<int> &) {
+        execl("/bin/true", "true", nullptr);
+    }));
+
+    /* grow and touch memory like portod with many containers */
+    std::vector<char> ballast((size_t)rssMb << 20);
+    for (size_t off = 0; off < ballast.size(); off += 4096)
+        ballast[off] = 1;
+
+    std::cout << "Helper spawns: " << spawns << " RSS: " << rssMb << " MB" << std::endl;
+
+    uint64_t start = BenchTimeUs();
+    for (int i = 0; i < spawns; i++) {
+        pid_t pid = fork();
+        if (!pid) {
+            execl("/bin/true", "true", nullptr);
+            _exit(EXIT_FAILURE);
+        }
+        int status;
+        ExpectEq(waitpid(pid, &status, 0), pid);
+        ExpectEq(status, 0);
+    }
+    uint64_t forkUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    start = BenchTimeUs();
+    for (int i = 0; i < spawns; i++) {
+        TZygoteTask task;
+        ExpectOk(zygote.Spawn({}, {}, task));
+        ExpectOk(task.Wait());
+    }
+    uint64_t zygoteUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    zygote.Stop();
+
+    SpawnReportTime("fork", forkUs, spawns);
+    SpawnReportTime("zygote", zygoteUs, spawns);
+
+    return 0;
+}
+
+/* Spawn latency into cgroup: attach by write into cgroup.procs vs clone3 */
+int CloneBench(int spawns, const std::string &cgroup2) {
+    TPath cg = TPath(cgroup2) / "porto-clone-bench";
+    TFile dir;
+    int status;
+
+    ExpectOk(cg.Mkdir(0755));
+    ExpectOk(dir.OpenDir(cg));
+
+    std::string procs = (cg / "cgroup.procs").ToString();
+
+    std::cout << "Spawns: " << spawns << " cgroup: " << cg << std::endl;
+
+    uint64_t start = BenchTimeUs();
+    for (int i = 0; i < spawns; i++) {
+        pid_t pid = fork();
+        if (!pid)
+            _exit(TPath(procs).WriteAll(std::to_string(GetPid())) ? EXIT_FAILURE : EXIT_SUCCESS);
+        ExpectEq(waitpid(pid, &status, 0), pid);
+        ExpectEq(status, 0);
+    }
+    uint64_t attachUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    uint64_t cloneUs = 0;
+    pid_t pid = Clone3(0, SIGCHLD, dir.Fd);
+    if (!pid)
+        _exit(EXIT_SUCCESS);
+    if (pid < 0) {
+        std::cout << "clone3 into cgroup is not supported: " << TError::System("clone3") << std::endl;
+    } else {
+        ExpectEq(waitpid(pid, &status, 0), pid);
+
+        start = BenchTimeUs();
+        for (int i = 0; i < spawns; i++) {
+            pid = Clone3(0, SIGCHLD, dir.Fd);
+            if (!pid)
+                _exit(EXIT_SUCCESS);
+            ExpectNeq(pid, -1);
+            ExpectEq(waitpid(pid, &status, 0), pid);
+            ExpectEq(status, 0);
+        }
+        cloneUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+    }
+
+    dir.Close();
+    ExpectOk(cg.Rmdir());
+
+    SpawnReportTime("fork+attach", attachUs, spawns);
+    if (cloneUs)
+        SpawnReportTime("clone3", cloneUs, spawns);
+
+    return 0;
+}
+
+static void *KillBenchThread(void *) {
+    while (true)
+        pause();
+    return nullptr;
+}
+
+/* Forks process with many threads inside cgroup */
+static pid_t KillBenchSpawn(const TPath &cg, int threads) {
+    int pfd[2];
+
+    ExpectEq(pipe(pfd), 0);
+
+    pid_t pid = fork();
+    if (!pid) {
+        pthread_attr_t attr;
+        pthread_t thread;
+
+        close(pfd[0]);
+        if ((cg / "cgroup.procs").WriteAll(std::to_string(GetPid())))
+            _exit(EXIT_FAILURE);
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, 64 << 10);
+        for (int i = 0; i < threads; i++)
+            if (pthread_create(&thread, &attr, KillBenchThread, nullptr))
+                _exit(EXIT_FAILURE);
+        (void)!write(pfd[1], "", 1);
+        while (true)
+            pause();
+    }
+
+    char c;
+    close(pfd[1]);
+    ExpectEq(read(pfd[0], &c, 1), 1);
+    close(pfd[0]);
+
+    return pid;
+}
+
+static void KillBenchTasks(const TPath &cg, std::vector<pid_t> &tasks) {
+    std::string text;
+    tasks.clear();
+    ExpectOk((cg / "cgroup.threads").ReadAll(text));
+    for (auto &line: SplitString(text, '\n')) {
+        int pid;
+        if (!StringToInt(line, pid))
+            tasks.push_back(pid);
+    }
+}
+
+int KillBench(int threads, const std::string &cgroup2) {
+    TPath cg = TPath(cgroup2) / "porto-kill-bench";
+    std::mutex tidsMutex;
+    std::unordered_set<pid_t> portoTids;
+    std::vector<pid_t> tasks;
+    int status;
+
+    ExpectOk(cg.Mkdir(0755));
+
+    std::cout << "Threads: " << threads << " cgroup: " << cg << std::endl;
+
+    for (auto method: {"list", "set", "cgroup.kill"}) {
+        if (!strcmp(method, "cgroup.kill") && !(cg / "cgroup.kill").Exists()) {
+            std::cout << method << ": not supported" << std::endl;
+            continue;
+        }
+
+        pid_t pid = KillBenchSpawn(cg, threads);
+        uint64_t reads = 0;
+        uint64_t start = BenchTimeUs();
+
+        if (!strcmp(method, "list")) {
+            /* Former TCgroup::KillAll */
+            std::vector<pid_t> killed;
+            bool retry;
+            do {
+                KillBenchTasks(cg, tasks);
+                reads++;
+                retry = false;
+                for (auto tid: tasks) {
+                    std::unique_lock<std::mutex> lock(tidsMutex);
+                    bool porto = portoTids.find(tid) != portoTids.end();
+                    lock.unlock();
+                    if (porto)
+                        continue;
+                    if (std::find(killed.begin(), killed.end(), tid) == killed.end()) {
+                        (void)kill(tid, SIGKILL);
+                        retry = true;
+                    }
+                }
+                killed = tasks;
+            } while (retry);
+        } else if (!strcmp(method, "set")) {
+            std::unordered_set<pid_t> killed, current;
+            bool retry;
+            do {
+                KillBenchTasks(cg, tasks);
+                reads++;
+                retry = false;
+                current.clear();
+                std::unique_lock<std::mutex> lock(tidsMutex);
+                for (auto tid: tasks)
+                    if (!portoTids.count(tid))
+                        current.insert(tid);
+                lock.unlock();
+                for (auto tid: current) {
+                    if (!killed.count(tid)) {
+                        (void)kill(tid, SIGKILL);
+                        retry = true;
+                    }
+                }
+                killed.swap(current);
+            } while (retry);
+        } else {
+            ExpectOk((cg / "cgroup.kill").WriteAll("1"));
+        }
+
+        uint64_t killUs = BenchTimeUs() - start;
+
+        ExpectEq(waitpid(pid, &status, 0), pid);
+        uint64_t totalUs = BenchTimeUs() - start;
+
+        std::cout << method << ": reads: " << reads << " kill: " << killUs << " us"
+                  << " until dead: " << totalUs << " us" << std::endl;
+    }
+
+    ExpectOk(cg.Rmdir());
+
+    return 0;
+}
+
+/* Network namespace for container: unshare vs setns into pre-created */
+int NetnsBench(int count) {
+    int curNs = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+    std::vector<int> pool;
+
+    ExpectNeq(curNs, -1);
+
+    std::cout << "Namespaces: " << count << std::endl;
+
+    uint64_t start = BenchTimeUs();
+    for (int i = 0; i < count; i++) {
+        ExpectEq(unshare(CLONE_NEWNET), 0);
+        int fd = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+        ExpectNeq(fd, -1);
+        ExpectEq(setns(curNs, CLONE_NEWNET), 0);
+        close(fd);
+    }
+    uint64_t unshareUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    for (int i = 0; i < count; i++) {
+        ExpectEq(unshare(CLONE_NEWNET), 0);
+        pool.push_back(open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC));
+        ExpectNeq(pool.back(), -1);
+    }
+    ExpectEq(setns(curNs, CLONE_NEWNET), 0);
+
+    start = BenchTimeUs();
+    for (auto fd: pool) {
+        ExpectEq(setns(fd, CLONE_NEWNET), 0);
+        ExpectEq(setns(curNs, CLONE_NEWNET), 0);
+        close(fd);
+    }
+    uint64_t poolUs = std::max(BenchTimeUs() - start, (uint64_t)1);
+
+    close(curNs);
+
+    SpawnReportTime("unshare", unshareUs, count);
+    SpawnReportTime("pool", poolUs, count);
+
+    return 0;
+}
+
+static uint64_t WarmIdle(Porto::Connection &api) {
+    std::string value;
+    uint64_t idle = 0;
+
+    ExpectApiSuccess(api.GetProperty("/", "porto_stat[warm_pool_idle]", value));
+    ExpectOk(StringToUint64(value, idle));
+    return idle;
+}
+
+/* Cold start creates the same root volume through api before start */
+int WarmStartBench(const std::string &name, int count) {
+    const cfg::TConfig::TContainerCfg::TWarmTemplate *tmpl = nullptr;
+    uint64_t coldUs = 0, warmUs = 0, start;
+
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    ReadConfigs();
+    Porto::Connection api;
+
+    for (auto &it: config().container().warm_template())
+        if (it.name() == name)
+            tmpl = &it;
+
+    if (!tmpl) {
+        std::cerr << "Unknown warm template " << name << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Starts: " << count << " template: " << name << std::endl;
+
+    for (int i = 0; i < count; i++) {
+        std::string ct = "warmbench-cold" + std::to_string(i);
+        rpc::TVolumeSpec spec, result;
+
+        ExpectApiSuccess(api.Create(ct));
+        ExpectApiSuccess(api.SetProperty(ct, "command", "true"));
+        if (tmpl->net_isolate())
+            ExpectApiSuccess(api.SetProperty(ct, "net", "none"));
+
+        start = BenchTimeUs();
+
+        if (tmpl->has_backend())
+            spec.set_backend(tmpl->backend());
+        if (tmpl->has_place())
+            spec.set_place(tmpl->place());
+        if (tmpl->has_space_limit())
+            spec.mutable_space()->set_limit(tmpl->space_limit());
+        for (auto &layer: tmpl->layers())
+            spec.add_layers(layer);
+        spec.add_links()->set_container(ct);
+
+        ExpectApiSuccess(api.CreateVolumeFromSpec(spec, result));
+        ExpectApiSuccess(api.SetProperty(ct, "root", result.path()));
+        ExpectApiSuccess(api.Start(ct));
+
+        coldUs += BenchTimeUs() - start;
+
+        ExpectApiSuccess(api.Destroy(ct));
+    }
+
+    for (int i = 0; i < count; i++) {
+        std::string ct = "warmbench-warm" + std::to_string(i);
+
+        /* Measure claims only, give pool time to refill */
+        for (int wait = 0; wait < 600 && WarmIdle(api) < tmpl->size(); wait++)
+            usleep(100000);
+
+        ExpectApiSuccess(api.Create(ct));
+        ExpectApiSuccess(api.SetProperty(ct, "command", "true"));
+        if (tmpl->net_isolate())
+            ExpectApiSuccess(api.SetProperty(ct, "net", "none"));
+        ExpectApiSuccess(api.SetProperty(ct, "warm_template", name));
+
+        start = BenchTimeUs();
+        ExpectApiSuccess(api.Start(ct));
+        warmUs += BenchTimeUs() - start;
+
+        ExpectApiSuccess(api.Destroy(ct));
+    }
+
+    coldUs = std::max(coldUs, (uint64_t)1);
+    warmUs = std::max(warmUs, (uint64_t)1);
+
+    SpawnReportTime("cold", coldUs, count);
+    SpawnReportTime("warm", warmUs, count);
+
+    return 0;
+}
+
 int StressTest(int threads, int iter, bool killPorto) {
     int i;
     std::vector<std::thread> thrTasks;
@@ -377,6 +377,59 @@ if Catch(c.Find, container_name) != porto.exceptions.ContainerDoesNotExist:
 
 Catch(c.Destroy, container_name)
 
+# START CONTAINERS
+
+c.Create(container_name)
+names = []
+for i in range(8):
+    b = c.Create("{}/{}".format(container_name, i))
+    b.SetProperty("command", "sleep 60")
+    names.append(b.name)
+
+res = c.StartContainers(names + [container_name + "/missing"])
+for name in names:
+    assert res[name] is None
+    assert c.GetData(name, "state") == "running"
+assert isinstance(res[container_name + "/missing"], porto.exceptions.ContainerDoesNotExist)
+assert c.GetData(container_name, "state") == "meta"
+
+res = c.StartContainers(names[:1])
+assert isinstance(res[names[0]], porto.exceptions.InvalidState)
+
+c.Destroy(container_name)
+
+# Stopped parent between requested containers is started by child
+c.Create(container_name)
+c.Create(container_name + "/b")
+b = c.Create(container_name + "/b/c")
+b.SetProperty("command", "sleep 60")
+
+res = c.StartContainers([b.name, container_name])
+assert res[container_name] is None
+assert res[b.name] is None
+assert c.GetData(container_name + "/b", "state") == "meta"
+assert c.GetData(b.name, "state") == "running"
+
+c.Destroy(container_name)
+
+# ASYNC DESTROY
+
+c.Run(container_name, command="sleep 60")
+c.Run(container_name + "/a", command="sleep 60")
+c.Destroy(container_name, asynchronous=True)
+assert Catch(c.Find, container_name) == porto.exceptions.ContainerDoesNotExist
+assert Catch(c.Find, container_name + "/a") == porto.exceptions.ContainerDoesNotExist
+assert container_name not in c.List()
+assert Catch(c.Create, container_name + "/b") == porto.exceptions.ContainerDoesNotExist
+assert Catch(c.SetProperty, container_name, "command", "true") == porto.exceptions.ContainerDoesNotExist
+assert Catch(c.Start, container_name) == porto.exceptions.ContainerDoesNotExist
+
+for i in range(100):
+    if Catch(c.Create, container_name) != porto.exceptions.Busy:
+        break
+    time.sleep(0.1)
+c.Destroy(container_name)
+
 
 # PID and RECONNECT
 
@@ -0,0 +1,71 @@
+#!/usr/bin/python
+
+import os
+import time
+import porto
+from test_common import *
+
+MEMORY = "/sys/fs/cgroup/memory"
+FREEZER = "/sys/fs/cgroup/freezer"
+
+conn = porto.Connection()
+
+def PoolStat(name):
+    return int(conn.GetProperty('/', 'porto_stat[cgroup_pool_{}]'.format(name)))
+
+def WaitFor(check):
+    for i in range(300):
+        if check():
+            return
+        time.sleep(0.1)
+    Expect(check())
+
+def PoolCgroups(kind):
+    return [d for d in os.listdir(MEMORY) if d.startswith("porto%%{}%".format(kind))] + \
+           [d for d in os.listdir(FREEZER + "/porto") if d.startswith("%{}%".format(kind))]
+
+ConfigurePortod('test-cgroup-pool', """
+daemon {
+    cgroup_pool_size: 4
+}
+""")
+
+try:
+    conn = porto.Connection()
+    pid = GetPortodPid()
+
+    WaitFor(lambda: len(PoolCgroups("pool")) >= 4)
+    for d in PoolCgroups("pool"):
+        Expect("%{}-".format(pid) in d)
+
+    taken = PoolStat("taken")
+    a = conn.Run("a", command="sleep 1000")
+    ExpectLe(taken + 1, PoolStat("taken"))
+
+    # taken cgroups are renamed to regular container names
+    Expect(os.path.isdir(MEMORY + "/porto%a"))
+    Expect(os.path.isdir(FREEZER + "/porto/a"))
+    ExpectEq(a.GetProperty("cgroups[memory]"), MEMORY + "/porto%a")
+
+    a.Destroy()
+    ExpectEq(os.path.exists(MEMORY + "/porto%a"), False)
+    ExpectEq(os.path.exists(FREEZER + "/porto/a"), False)
+    WaitFor(lambda: len(PoolCgroups("trash")) == 0)
+
+    # pool is refilled in background
+    WaitFor(lambda: len(PoolCgroups("pool")) >= 4)
+    stale = set(PoolCgroups("pool"))
+
+    ReloadPortod()
+    conn = porto.Connection()
+    pid = GetPortodPid()
+
+    # leftovers of previous instance are swept at start
+    WaitFor(lambda: len(PoolCgroups("pool")) >= 4)
+    ExpectEq(stale & set(PoolCgroups("pool")), set())
+    ExpectEq(PoolCgroups("trash"), [])
+    for d in PoolCgroups("pool"):
+        Expect("%{}-".format(pid) in d)
+
+finally:
+    ConfigurePortod('test-cgroup-pool', "")
@@ -180,3 +180,28 @@ a["command"] = "func() {false}; func"
 ExpectEq(Catch(a.Start), porto.exceptions.InvalidCommand)
 
 a.Destroy()
+
+# SIGKILL freezes cgroup before the first pass, forking tasks cannot escape
+def ReadProcs(name):
+    with open("/sys/fs/cgroup/freezer/porto/{}/cgroup.procs".format(name)) as f:
+        return [int(pid) for pid in f.read().split()]
+
+b = c.Run("b", weak=True, command="bash -c 'while true; do sleep 1000 & sleep 0.01; done'")
+time.sleep(1)
+pids = ReadProcs("b")
+ExpectLe(2, len(pids))
+b.Stop()
+ExpectEq(b["state"], "stopped")
+for pid in pids:
+    ExpectEq(IsRunning(pid), False)
+
+# Already frozen container thaws after kill
+b.Start()
+time.sleep(1)
+b.Pause()
+pids = ReadProcs("b")
+b.Stop()
+ExpectEq(b["state"], "stopped")
+for pid in pids:
+    ExpectEq(IsRunning(pid), False)
+b.Destroy()
@@ -670,6 +670,23 @@ try:
     for n in dump.spec.net_guarantee.map:
         assert net_guarantees.find('{}: {}'.format(n.key, n.val)) != -1
 
+# check spec diff
+    spec = porto.rpc_pb2.TContainerSpec()
+    spec.command = 'sleep 1234'
+    ExpectEq(a.LoadSpec(spec), ['command'])
+    ExpectEq(a.LoadSpec(spec), [])
+    spec.command = 'sleep 4321'
+    ExpectEq(a.LoadSpec(spec), ['command'])
+    ExpectEq(a.GetProperty('command'), 'sleep 4321')
+
+# inherited value equal to requested is pinned once
+    b = c.Create('test-spec-pin', weak=True)
+    spec = porto.rpc_pb2.TContainerSpec()
+    spec.cwd = b.GetProperty('cwd')
+    ExpectEq(b.LoadSpec(spec), ['cwd'])
+    ExpectEq(b.LoadSpec(spec), [])
+    b.Destroy()
+
 
     speca = clean_spec
     speca.command = 'sleep 6317'
@@ -0,0 +1,55 @@
+#!/usr/bin/python
+
+import porto
+from test_common import *
+
+conn = porto.Connection()
+
+def HgramCount(hgrams, name):
+    for h in hgrams:
+        if h['name'] == name:
+            return sum([int(b.split(':')[1]) for b in h['value'].split(';')])
+    return 0
+
+before = conn.Call('GetSystem').get('start_timing_hgram', [])
+
+a = conn.Run("a", command="true", wait=5)
+ExpectProp(a, "state", "dead")
+
+timings = {}
+for phase in a.GetProperty("start_timings").split("; "):
+    name, value = phase.split(": ")
+    timings[name] = int(value)
+
+Expect("total" in timings)
+ExpectEq(int(a.GetProperty("start_timings[total]")), timings["total"])
+Expect(timings["total"] > 0)
+
+# phases reported by the task child
+for step in ["fork", "cgroups", "streams", "exec"]:
+    Expect("task_" + step in timings)
+    ExpectEq(int(a.GetProperty("start_timings[task_{}]".format(step))), timings["task_" + step])
+for name in timings:
+    if name.startswith("task_"):
+        Expect(timings[name] > 0)
+
+ExpectLe(sum([timings[name] for name in timings if name.startswith("task_")]), timings["total"])
+
+ExpectException(a.GetProperty, porto.exceptions.InvalidProperty, "start_timings[unknown]")
+
+after = conn.Call('GetSystem').get('start_timing_hgram', [])
+for name in ["total", "task_fork", "task_exec"]:
+    ExpectLe(HgramCount(before, name) + 1, HgramCount(after, name))
+
+# timings are cleared by the next start
+a.Stop()
+a.SetProperty("command", "false")
+a.Start()
+a.Wait()
+ExpectEq(a.GetProperty("start_timings").count("total:"), 1)
+
+a.Destroy()
+
+m = conn.Run("m")
+Expect(int(m.GetProperty("start_timings[total]")) > 0)
+m.Destroy()
@@ -102,3 +102,34 @@ ExpectEq(b['exit_code'], '0')
 b.Destroy()
 
 ct.Destroy()
+
+# circular log: only last stdout_limit bytes survive, reads follow logical offsets
+ConfigurePortod('test-std-streams-ring', """
+container {
+    std_stream_ring: true
+}""")
+
+try:
+    limit = 4096
+    data = "".join(["{:09d}\n".format(i) for i in range(1, 1001)])
+
+    a = c.Run('test', command="bash -c 'for i in $(seq 1000); do printf \"%09d\\n\" $i; done'", stdout_limit=limit)
+    a.Wait()
+
+    # writer drains pipe after task exit
+    for i in range(100):
+        if a.GetProperty("stdout") == data[-limit:]:
+            break
+        time.sleep(0.1)
+    ExpectEq(a.GetProperty("stdout"), data[-limit:])
+
+    head = len(data) - limit
+
+    # ring wraps at logical offset 2 * limit
+    ExpectEq(a.GetProperty("stdout[{}:{}]".format(head + 100, limit)), data[head + 100:])
+    ExpectEq(a.GetProperty("stdout[{}:{}]".format(2 * limit - 10, 20)), data[2 * limit - 10:2 * limit + 10])
+    ExpectEq(Catch(a.GetProperty, "stdout[{}:{}]".format(head - 1, 10)), porto.exceptions.InvalidData)
+
+    a.Destroy()
+finally:
+    ConfigurePortod('test-std-streams-ring', "")
@@ -42,3 +42,43 @@ a = c.Run("a", weak=False, command="sleep 1000")
 ReloadPortod()
 a.Destroy()
 ExpectEq(events, [])
+
+# batched async wait merges queued reports and drops oldest above limit,
+# zero limit still keeps the latest report
+for limit in [10, 0]:
+    ConfigurePortod('test-wait-batch', """
+daemon {
+    max_queued_reports: %d
+}""" % limit)
+
+    c = porto.Connection()
+    w = porto.Connection()
+
+    names = ["batch-{}".format(i) for i in range(20)]
+    cts = [c.Create(name) for name in names]
+
+    batch = {}
+    def batch_event(name, state, when, label=None, value=None):
+        batch[name] = value
+        batch['count'] = batch.get('count', 0) + 1
+
+    w.AsyncWait(["batch-*"], batch_event, labels=["TEST.*"], batch=True)
+
+    # watcher does not read, socket fills and reports are queued
+    total = 20000
+    for i in range(total):
+        cts[i % len(cts)].SetLabel("TEST.seq", str(i))
+
+    # any request delivers pending batches
+    w.List()
+
+    Expect(batch['count'] < total)
+    for i in range(total - max(limit, 1), total):
+        ExpectEq(batch[names[i % len(cts)]], str(i))
+
+    w.Disconnect()
+    for ct in cts:
+        ct.Destroy()
+    c.Disconnect()
+
+ConfigurePortod('test-wait-batch', "")
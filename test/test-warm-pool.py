@@ -0,0 +1,125 @@
+#!/usr/bin/python
+
+import time
+import porto
+from test_common import *
+
+conn = porto.Connection()
+
+def WarmStat(name):
+    return int(conn.GetProperty('/', 'porto_stat[warm_pool_{}]'.format(name)))
+
+def WaitFor(check):
+    for i in range(300):
+        if check():
+            return
+        time.sleep(0.1)
+    Expect(check())
+
+def WarmVolumes():
+    return [v for v in conn.ListVolumes() if v.GetProperty('private').startswith('porto-warm')]
+
+ConfigurePortod('test-warm-pool', """
+container {
+    warm_template {
+        name: "test"
+        size: 2
+        layers: "ubuntu-xenial"
+        net_isolate: true
+    }
+    warm_template {
+        name: "cold"
+        size: 0
+        layers: "ubuntu-xenial"
+        net_isolate: true
+    }
+}""")
+
+try:
+    a = conn.Create('a')
+    ExpectException(a.SetProperty, porto.exceptions.InvalidValue, 'warm_template', 'missing')
+    a.Destroy()
+
+    WaitFor(lambda: WarmStat('idle') == 2)
+    ExpectEq(len(WarmVolumes()), 2)
+
+    claimed = WarmStat('claimed')
+
+    a = conn.Run('a', command='sleep 1000', net='none', warm_template='test')
+    ExpectEq(WarmStat('claimed'), claimed + 1)
+
+    root = a.GetProperty('root')
+    v = conn.FindVolume(root)
+    ExpectEq(v.GetProperty('owner_container'), 'a')
+
+    # pool drops root link and private marker of claimed volume
+    WaitFor(lambda: [c.name for c in v.GetContainers()] == ['a'])
+    ExpectEq(v.GetProperty('private'), '')
+
+    # netns is taken from pool too
+    ExpectNe(os.readlink('/proc/{}/ns/net'.format(a.GetProperty('root_pid'))),
+             os.readlink('/proc/self/ns/net'))
+
+    # pool is refilled
+    WaitFor(lambda: WarmStat('idle') == 2)
+
+    # warm root is runtime state and survives restart
+    ReloadPortod()
+    ExpectEq(WarmStat('idle'), 2)
+    ExpectEq(a.GetProperty('root'), root)
+    ExpectEq(a.GetProperty('state'), 'running')
+
+    # volume goes away at stop, next start claims again
+    a.Stop()
+    ExpectEq(a.GetProperty('root'), '/')
+    ExpectException(conn.FindVolume, porto.exceptions.VolumeNotFound, root)
+
+    a.Start()
+    ExpectEq(WarmStat('claimed'), claimed + 2)
+    root = a.GetProperty('root')
+    ExpectNe(root, '/')
+
+    # container volume goes away with container
+    a.Destroy()
+    ExpectException(conn.FindVolume, porto.exceptions.VolumeNotFound, root)
+
+    # warm start is faster than creating the same volume at start
+    def StartTime(template, count=3):
+        total = 0
+        for i in range(count):
+            WaitFor(lambda: WarmStat('idle') == 2)
+            ct = conn.Create('bench')
+            ct.SetProperty('command', 'sleep 1000')
+            ct.SetProperty('net', 'none')
+            ct.SetProperty('warm_template', template)
+            start = time.time()
+            ct.Start()
+            total += time.time() - start
+            ct.Destroy()
+        return total / count
+
+    missed = WarmStat('missed')
+    cold = StartTime('cold')
+    ExpectEq(WarmStat('missed'), missed + 3)
+    warm = StartTime('test')
+    print("start cold {:.3f}s warm {:.3f}s".format(cold, warm))
+    Expect(warm < cold)
+
+    # container of removed template is restored and cannot start
+    b = conn.Create('b')
+    b.SetProperty('command', 'sleep 1000')
+    b.SetProperty('warm_template', 'test')
+
+    ConfigurePortod('test-warm-pool', "")
+
+    b = conn.Find('b')
+    ExpectEq(b.GetProperty('state'), 'stopped')
+    ExpectEq(b.GetProperty('warm_template'), 'test')
+    ExpectException(b.Start, porto.exceptions.InvalidValue)
+    b.Destroy()
+
+finally:
+    ConfigurePortod('test-warm-pool', "")
+
+# without template stale idle volumes are destroyed
+WaitFor(lambda: len(WarmVolumes()) == 0)
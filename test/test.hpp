@@ -67,6 +67,14 @@ namespace test {
 
     int SelfTest(std::vector<std::string> args);
     int StressTest(int threads, int iter, bool killPorto);
+    int StressBench(int threads, int iter);
+    int RegistryBench(int count, int iter);
+    int WaiterBench(int count, int changes);
+    int ZygoteBench(int spawns, int rssMb);
+    int CloneBench(int spawns, const std::string &cgroup2);
+    int KillBench(int threads, const std::string &cgroup2);
+    int NetnsBench(int count);
+    int WarmStartBench(const std::string &name, int count);
     int FuzzyTest(int threads, int iter);
 
     enum class KernelFeature {